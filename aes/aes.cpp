@@ -38,6 +38,7 @@ static const int DEFAULT_ITERATIONS = 16;
 static const int DEFAULT_BUF_SIZE = 128;
 static const int DEFAULT_NUM_THREADS = 1;
 static const int MAX_NUM_THREADS = 256;
+static const int DEFAULT_SECTOR_SIZE = 4096;
 
 enum CoreBinding {
   NoCoreBinding,
@@ -72,6 +73,13 @@ int gVerbose = 0;
 bool gDoCrosscrypt = true;
 ALIGN16 unsigned char gIV[32] = { 0 };
 ALIGN16 unsigned char gKey[32] = { 0 };
+// GCM: Tag jedes Threads von der Ver- zur Entschluesselung
+unsigned char gTag[MAX_NUM_THREADS][16];
+// XTS: Daten- und Tweak-Schluessel hintereinander
+ALIGN16 unsigned char gXtsKey[64] = { 0 };
+int gSectorSize = DEFAULT_SECTOR_SIZE;
+// Multi-Buffer-CBC: Laengen der unabhaengigen Stroeme, die einen Puffer fuellen
+std::vector<int> gStreamLengths;
 char* gInFile = NULL;
 char* gOutFile = NULL;
 CoreBinding gCoreBinding = AutomaticCoreBinding;
@@ -86,7 +94,8 @@ enum _long_options {
   SELECT_IN_FILE,
   SELECT_OUT_FILE,
   SELECT_NO_CROSS_CRYPT,
-  SELECT_PASSWORD
+  SELECT_PASSWORD,
+  SELECT_SECTOR_SIZE
 };
 static struct option long_options[] = {
   { "core-binding",  required_argument, 0, SELECT_CORE_BINDING },
@@ -96,10 +105,23 @@ static struct option long_options[] = {
   { "out",           required_argument, 0, SELECT_OUT_FILE },
   { "no-cross",      no_argument,       0, SELECT_NO_CROSS_CRYPT },
   { "password",      required_argument, 0, SELECT_PASSWORD },
+  { "sector-size",   required_argument, 0, SELECT_SECTOR_SIZE },
   { "help",          no_argument,       0, SELECT_HELP }
 };
 
 static const unsigned int DecryptMode = 0x80000000U;
+// Varianten der CBC-Entschluesselung mit AES-NI: ein Block nach dem
+// anderen bzw. 4 Bloecke parallel (ohne Flag: 8 Bloecke parallel)
+static const unsigned int SerialMode = 0x40000000U;
+static const unsigned int FourWayMode = 0x20000000U;
+// CTR- statt CBC-Modus
+static const unsigned int CtrMode = 0x10000000U;
+// GCM (CTR plus GHASH)
+static const unsigned int GcmMode = 0x08000000U;
+// XTS mit Sektoren zu gSectorSize Bytes
+static const unsigned int XtsMode = 0x04000000U;
+// CBC-Verschluesselung vieler unabhaengiger Stroeme (gStreamLengths)
+static const unsigned int MultiBufferMode = 0x02000000U;
 enum Method {
   AES128Enc = 1 << 0,
   AES192Enc = 1 << 1,
@@ -112,7 +134,51 @@ enum Method {
   AES256Dec = AES256Enc | DecryptMode,
   OpenSSL128Dec = OpenSSL128Enc | DecryptMode,
   OpenSSL192Dec = OpenSSL192Enc | DecryptMode,
-  OpenSSL256Dec = OpenSSL256Enc | DecryptMode
+  OpenSSL256Dec = OpenSSL256Enc | DecryptMode,
+  AES128DecSerial = AES128Dec | SerialMode,
+  AES192DecSerial = AES192Dec | SerialMode,
+  AES256DecSerial = AES256Dec | SerialMode,
+  AES128Dec4 = AES128Dec | FourWayMode,
+  AES192Dec4 = AES192Dec | FourWayMode,
+  AES256Dec4 = AES256Dec | FourWayMode,
+  AES128Ctr = AES128Enc | CtrMode,
+  AES192Ctr = AES192Enc | CtrMode,
+  AES256Ctr = AES256Enc | CtrMode,
+  OpenSSL128Ctr = OpenSSL128Enc | CtrMode,
+  OpenSSL192Ctr = OpenSSL192Enc | CtrMode,
+  OpenSSL256Ctr = OpenSSL256Enc | CtrMode,
+  AES128CtrDec = AES128Ctr | DecryptMode,
+  AES192CtrDec = AES192Ctr | DecryptMode,
+  AES256CtrDec = AES256Ctr | DecryptMode,
+  OpenSSL128CtrDec = OpenSSL128Ctr | DecryptMode,
+  OpenSSL192CtrDec = OpenSSL192Ctr | DecryptMode,
+  OpenSSL256CtrDec = OpenSSL256Ctr | DecryptMode,
+  AES128Gcm = AES128Enc | GcmMode,
+  AES192Gcm = AES192Enc | GcmMode,
+  AES256Gcm = AES256Enc | GcmMode,
+  OpenSSL128Gcm = OpenSSL128Enc | GcmMode,
+  OpenSSL192Gcm = OpenSSL192Enc | GcmMode,
+  OpenSSL256Gcm = OpenSSL256Enc | GcmMode,
+  AES128GcmDec = AES128Gcm | DecryptMode,
+  AES192GcmDec = AES192Gcm | DecryptMode,
+  AES256GcmDec = AES256Gcm | DecryptMode,
+  OpenSSL128GcmDec = OpenSSL128Gcm | DecryptMode,
+  OpenSSL192GcmDec = OpenSSL192Gcm | DecryptMode,
+  OpenSSL256GcmDec = OpenSSL256Gcm | DecryptMode,
+  AES128Xts = AES128Enc | XtsMode,
+  AES256Xts = AES256Enc | XtsMode,
+  OpenSSL128Xts = OpenSSL128Enc | XtsMode,
+  OpenSSL256Xts = OpenSSL256Enc | XtsMode,
+  AES128XtsDec = AES128Xts | DecryptMode,
+  AES256XtsDec = AES256Xts | DecryptMode,
+  OpenSSL128XtsDec = OpenSSL128Xts | DecryptMode,
+  OpenSSL256XtsDec = OpenSSL256Xts | DecryptMode,
+  AES128EncMB = AES128Enc | MultiBufferMode,
+  AES256EncMB = AES256Enc | MultiBufferMode,
+  AES128EncStreams = AES128EncMB | SerialMode,
+  AES256EncStreams = AES256EncMB | SerialMode,
+  AES128DecStreams = AES128EncMB | DecryptMode,
+  AES256DecStreams = AES256EncMB | DecryptMode
 };
 
 struct BenchmarkResult {
@@ -145,6 +211,8 @@ struct BenchmarkResult {
   ALIGN16 AES_KEY decKey;
   ALIGN16 AES_KEY_ALIGNED encKeyAligned;
   ALIGN16 AES_KEY_ALIGNED decKeyAligned;
+  ALIGN16 AES_GCM_KEY gcmKey;
+  ALIGN16 AES_KEY_ALIGNED tweakKeyAligned;
   ALIGN16 unsigned char* plainBuf;
   ALIGN16 unsigned char* encBuf;
   ALIGN16 unsigned char* decBuf;
@@ -186,6 +254,98 @@ int AES_cbc_decrypt(unsigned char* enc, unsigned char* dec, int len, const EVP_C
   return p_len + f_len;
 }
 
+// Ver- und Entschluesselung sind im CTR-Modus identisch. Der Zaehler wird
+// bei jedem Aufruf auf iv zurueckgesetzt, denn EVP_EncryptInit_ex() ohne iv
+// wuerde mit dem Zaehler des vorigen Aufrufs weitermachen.
+int AES_ctr_crypt(unsigned char* in, unsigned char* out, int len, const unsigned char* iv, EVP_CIPHER_CTX *e)
+{
+  int c_len = len, f_len = 0;
+  if (!EVP_EncryptInit_ex(e, NULL, NULL, NULL, iv))
+    return -1;
+  if (!EVP_EncryptUpdate(e, out, &c_len, in, len))
+    return -2;
+  if (!EVP_EncryptFinal_ex(e, out + c_len, &f_len))
+    return -3;
+  return c_len + f_len;
+}
+
+// GCM mit 12 Byte langem IV und ohne AAD
+int AES_gcm_encrypt(unsigned char* plain, unsigned char* enc, int len, const unsigned char* iv, unsigned char tag[16], EVP_CIPHER_CTX *e)
+{
+  int c_len = len, f_len = 0;
+  if (!EVP_EncryptInit_ex(e, NULL, NULL, NULL, iv))
+    return -1;
+  if (!EVP_EncryptUpdate(e, enc, &c_len, plain, len))
+    return -2;
+  if (!EVP_EncryptFinal_ex(e, enc + c_len, &f_len))
+    return -3;
+  if (!EVP_CIPHER_CTX_ctrl(e, EVP_CTRL_GCM_GET_TAG, 16, tag))
+    return -4;
+  return c_len + f_len;
+}
+
+// liefert -3, wenn das Tag nicht stimmt
+int AES_gcm_decrypt(unsigned char* enc, unsigned char* dec, int len, const unsigned char* iv, unsigned char tag[16], EVP_CIPHER_CTX *e)
+{
+  int p_len = len, f_len = 0;
+  if (!EVP_DecryptInit_ex(e, NULL, NULL, NULL, iv))
+    return -1;
+  if (!EVP_CIPHER_CTX_ctrl(e, EVP_CTRL_GCM_SET_TAG, 16, tag))
+    return -4;
+  if (!EVP_DecryptUpdate(e, dec, &p_len, enc, len))
+    return -2;
+  if (!EVP_DecryptFinal_ex(e, dec + p_len, &f_len))
+    return -3;
+  return p_len + f_len;
+}
+
+// XTS-Tweak eines Sektors: Sektornummer, 128 Bit, Little Endian
+void xtsSectorIV(uint64_t sector, unsigned char iv[16])
+{
+  for (int i = 0; i < 16; ++i) {
+    iv[i] = (unsigned char)sector;
+    sector = (i < 7)? sector >> 8 : 0;
+  }
+}
+
+// len Bytes als Sektoren ab firstSector ver- oder entschluesseln, so wie
+// ein Volume-Treiber OpenSSL nutzen wuerde: pro Sektor ein neuer Tweak
+// (der letzte Sektor darf kuerzer sein)
+int AES_xts_crypt(unsigned char* in, unsigned char* out, int len, int sectorSize, uint64_t firstSector, EVP_CIPHER_CTX *e)
+{
+  unsigned char iv[16];
+  for (int offset = 0; offset < len; offset += sectorSize) {
+    int c_len = (len - offset < sectorSize)? len - offset : sectorSize;
+    xtsSectorIV(firstSector++, iv);
+    if (!EVP_CipherInit_ex(e, NULL, NULL, NULL, iv, -1))
+      return -1;
+    if (!EVP_CipherUpdate(e, out + offset, &c_len, in + offset, c_len))
+      return -2;
+  }
+  return len;
+}
+
+// dasselbe mit AES-NI: alle vollen Sektoren in einem Aufruf
+void AESNI_xts_crypt(unsigned char* in, unsigned char* out, int len, int sectorSize, uint64_t firstSector, AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, bool encrypt)
+{
+  const int numSectors = len / sectorSize;
+  const int rest = len - numSectors * sectorSize;
+  if (encrypt)
+    AESNI_xts_encrypt_sectors(in, out, sectorSize, numSectors, firstSector, key1, key2);
+  else
+    AESNI_xts_decrypt_sectors(in, out, sectorSize, numSectors, firstSector, key1, key2);
+  if (rest > 0) {
+    unsigned char iv[16];
+    xtsSectorIV(firstSector + numSectors, iv);
+    in += numSectors * sectorSize;
+    out += numSectors * sectorSize;
+    if (encrypt)
+      AESNI_xts_encrypt(in, out, rest, key1, key2, iv);
+    else
+      AESNI_xts_decrypt(in, out, rest, key1, key2, iv);
+  }
+}
+
 // die im Thread laufenden Benchmark-Routine
 #if defined(WIN32)
 DWORD WINAPI
@@ -238,10 +398,27 @@ void*
   }
   int64_t tMin = LLONG_MAX;
   int64_t ticksMin = LLONG_MAX;
+  std::vector<AESNI_CBC_JOB> jobs;
+  if (result->method & MultiBufferMode) {
+    int pos = result->threadNum * result->bufSize;
+    jobs.resize(gStreamLengths.size());
+    for (size_t j = 0; j < jobs.size(); ++j) {
+      jobs[j].in = result->plainBuf + pos;
+      jobs[j].out = result->encBuf + pos;
+      jobs[j].length = gStreamLengths[j];
+      jobs[j].key = &result->encKeyAligned;
+      pos += gStreamLengths[j];
+    }
+  }
   for (int i = 0; i < result->iterations; ++i) {
     int64_t t, ticks;
+    for (size_t j = 0; j < jobs.size(); ++j)
+      memcpy(jobs[j].ivec, gIV, sizeof(jobs[j].ivec));
     {
       unsigned char *plain, *enc, *dec;
+      ALIGN16 unsigned char ivec[16];
+      unsigned char ecount[16];
+      unsigned int num = 0;
       int status = 0;
       int offset = result->threadNum * result->bufSize;
       Stopwatch stopwatch(t, ticks);
@@ -249,6 +426,8 @@ void*
       {
       case AES128Enc:
         // fall-through
+      case AES192Enc:
+        // fall-through
       case AES256Enc:
         plain = (unsigned char*)result->plainBuf + offset;
         enc = (unsigned char*)result->encBuf + offset;
@@ -256,17 +435,43 @@ void*
         break;
       case AES128Dec:
         // fall-through
+      case AES192Dec:
+        // fall-through
       case AES256Dec:
         enc = (unsigned char*)result->encBuf + offset;
         dec = (unsigned char*)result->decBuf + offset;
         AESNI_cbc_decrypt(enc, dec, gIV, result->bufSize, &result->decKeyAligned);
         break;
+      case AES128Dec4:
+        // fall-through
+      case AES192Dec4:
+        // fall-through
+      case AES256Dec4:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        AESNI_cbc_decrypt4(enc, dec, gIV, result->bufSize, &result->decKeyAligned);
+        break;
+      case AES128DecSerial:
+        // fall-through
+      case AES192DecSerial:
+        // fall-through
+      case AES256DecSerial:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        AESNI_cbc_decrypt_serial(enc, dec, gIV, result->bufSize, &result->decKeyAligned);
+        break;
       case OpenSSL128Enc:
         plain = (unsigned char*)result->plainBuf + offset;
         enc = (unsigned char*)result->encBuf + offset;
         status = AES_cbc_encrypt(plain, enc, result->bufSize, EVP_aes_128_cbc(), result->encCtx);
         assert(status > 0);
         break;
+      case OpenSSL192Enc:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        status = AES_cbc_encrypt(plain, enc, result->bufSize, EVP_aes_192_cbc(), result->encCtx);
+        assert(status > 0);
+        break;
       case OpenSSL256Enc:
         plain = (unsigned char*)result->plainBuf + offset;
         enc = (unsigned char*)result->encBuf + offset;
@@ -278,11 +483,147 @@ void*
         dec = (unsigned char*)result->decBuf + offset;
         status = AES_cbc_decrypt(enc, dec, result->bufSize, EVP_aes_128_cbc(), result->decCtx);
         break;
+      case OpenSSL192Dec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        status = AES_cbc_decrypt(enc, dec, result->bufSize, EVP_aes_192_cbc(), result->decCtx);
+        break;
       case OpenSSL256Dec:
         enc = (unsigned char*)result->encBuf + offset;
         dec = (unsigned char*)result->decBuf + offset;
         status = AES_cbc_decrypt(enc, dec, result->bufSize, EVP_aes_256_cbc(), result->decCtx);
         break;
+      case AES128Ctr:
+        // fall-through
+      case AES192Ctr:
+        // fall-through
+      case AES256Ctr:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        memcpy(ivec, gIV, sizeof(ivec));
+        AESNI_ctr_crypt(plain, enc, result->bufSize, &result->encKeyAligned, ivec, ecount, &num);
+        break;
+      case AES128CtrDec:
+        // fall-through
+      case AES192CtrDec:
+        // fall-through
+      case AES256CtrDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        memcpy(ivec, gIV, sizeof(ivec));
+        AESNI_ctr_crypt(enc, dec, result->bufSize, &result->encKeyAligned, ivec, ecount, &num);
+        break;
+      case OpenSSL128Ctr:
+        // fall-through
+      case OpenSSL192Ctr:
+        // fall-through
+      case OpenSSL256Ctr:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        status = AES_ctr_crypt(plain, enc, result->bufSize, gIV, result->encCtx);
+        break;
+      case OpenSSL128CtrDec:
+        // fall-through
+      case OpenSSL192CtrDec:
+        // fall-through
+      case OpenSSL256CtrDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        status = AES_ctr_crypt(enc, dec, result->bufSize, gIV, result->encCtx);
+        break;
+      case AES128Gcm:
+        // fall-through
+      case AES192Gcm:
+        // fall-through
+      case AES256Gcm:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        AESNI_gcm_seal(&result->gcmKey, gIV, 12, NULL, 0, plain, enc, result->bufSize, gTag[result->threadNum]);
+        break;
+      case AES128GcmDec:
+        // fall-through
+      case AES192GcmDec:
+        // fall-through
+      case AES256GcmDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        // loescht bei falschem Tag den Klartext, was der Vergleich danach bemerkt
+        AESNI_gcm_open(&result->gcmKey, gIV, 12, NULL, 0, enc, dec, result->bufSize, gTag[result->threadNum]);
+        break;
+      case OpenSSL128Gcm:
+        // fall-through
+      case OpenSSL192Gcm:
+        // fall-through
+      case OpenSSL256Gcm:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        status = AES_gcm_encrypt(plain, enc, result->bufSize, gIV, gTag[result->threadNum], result->encCtx);
+        break;
+      case OpenSSL128GcmDec:
+        // fall-through
+      case OpenSSL192GcmDec:
+        // fall-through
+      case OpenSSL256GcmDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        if (AES_gcm_decrypt(enc, dec, result->bufSize, gIV, gTag[result->threadNum], result->decCtx) < 0)
+          memset(dec, 0, result->bufSize);
+        break;
+      case AES128Xts:
+        // fall-through
+      case AES256Xts:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        AESNI_xts_crypt(plain, enc, result->bufSize, gSectorSize, offset / gSectorSize, &result->encKeyAligned, &result->tweakKeyAligned, true);
+        break;
+      case AES128XtsDec:
+        // fall-through
+      case AES256XtsDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        AESNI_xts_crypt(enc, dec, result->bufSize, gSectorSize, offset / gSectorSize, &result->decKeyAligned, &result->tweakKeyAligned, false);
+        break;
+      case OpenSSL128Xts:
+        // fall-through
+      case OpenSSL256Xts:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        status = AES_xts_crypt(plain, enc, result->bufSize, gSectorSize, offset / gSectorSize, result->encCtx);
+        break;
+      case OpenSSL128XtsDec:
+        // fall-through
+      case OpenSSL256XtsDec:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        status = AES_xts_crypt(enc, dec, result->bufSize, gSectorSize, offset / gSectorSize, result->decCtx);
+        break;
+      case AES128EncMB:
+        // fall-through
+      case AES256EncMB:
+        AESNI_cbc_encrypt_mb(&jobs[0], jobs.size());
+        break;
+      case AES128EncStreams:
+        // fall-through
+      case AES256EncStreams:
+        plain = (unsigned char*)result->plainBuf + offset;
+        enc = (unsigned char*)result->encBuf + offset;
+        for (size_t j = 0; j < gStreamLengths.size(); ++j) {
+          AESNI_cbc_encrypt(plain, enc, gIV, gStreamLengths[j], &result->encKeyAligned);
+          plain += gStreamLengths[j];
+          enc += gStreamLengths[j];
+        }
+        break;
+      case AES128DecStreams:
+        // fall-through
+      case AES256DecStreams:
+        enc = (unsigned char*)result->encBuf + offset;
+        dec = (unsigned char*)result->decBuf + offset;
+        for (size_t j = 0; j < gStreamLengths.size(); ++j) {
+          AESNI_cbc_decrypt(enc, dec, gIV, gStreamLengths[j], &result->decKeyAligned);
+          enc += gStreamLengths[j];
+          dec += gStreamLengths[j];
+        }
+        break;
       }
       assert(status >= 0);
     } 
@@ -314,16 +655,70 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
   switch (method) {
   case AES128Enc:
   case AES128Dec:
+  case AES128Dec4:
+  case AES128DecSerial:
   case OpenSSL128Enc:
   case OpenSSL128Dec:
+  case AES128Ctr:
+  case AES128CtrDec:
+  case OpenSSL128Ctr:
+  case OpenSSL128CtrDec:
+  case AES128EncMB:
+  case AES128EncStreams:
+  case AES128DecStreams:
+  case AES128Gcm:
+  case AES128GcmDec:
+  case OpenSSL128Gcm:
+  case OpenSSL128GcmDec:
     EVP_BytesToKey(EVP_aes_128_cbc(), EVP_sha1(), NULL, (unsigned char*)gPassword, strlen(gPassword), 5, gKey, gIV);
     break;
+  case AES192Enc:
+  case AES192Dec:
+  case AES192Dec4:
+  case AES192DecSerial:
+  case OpenSSL192Enc:
+  case OpenSSL192Dec:
+  case AES192Ctr:
+  case AES192CtrDec:
+  case OpenSSL192Ctr:
+  case OpenSSL192CtrDec:
+  case AES192Gcm:
+  case AES192GcmDec:
+  case OpenSSL192Gcm:
+  case OpenSSL192GcmDec:
+    EVP_BytesToKey(EVP_aes_192_cbc(), EVP_sha1(), NULL, (unsigned char*)gPassword, strlen(gPassword), 6, gKey, gIV);
+    break;
   case AES256Enc:
   case AES256Dec:
+  case AES256Dec4:
+  case AES256DecSerial:
   case OpenSSL256Enc:
   case OpenSSL256Dec:
+  case AES256Ctr:
+  case AES256CtrDec:
+  case OpenSSL256Ctr:
+  case OpenSSL256CtrDec:
+  case AES256EncMB:
+  case AES256EncStreams:
+  case AES256DecStreams:
+  case AES256Gcm:
+  case AES256GcmDec:
+  case OpenSSL256Gcm:
+  case OpenSSL256GcmDec:
     EVP_BytesToKey(EVP_aes_256_cbc(), EVP_sha1(), NULL, (unsigned char*)gPassword, strlen(gPassword), 7, gKey, gIV);
     break;
+  case AES128Xts:
+  case AES128XtsDec:
+  case OpenSSL128Xts:
+  case OpenSSL128XtsDec:
+    EVP_BytesToKey(EVP_aes_128_xts(), EVP_sha1(), NULL, (unsigned char*)gPassword, strlen(gPassword), 5, gXtsKey, gIV);
+    break;
+  case AES256Xts:
+  case AES256XtsDec:
+  case OpenSSL256Xts:
+  case OpenSSL256XtsDec:
+    EVP_BytesToKey(EVP_aes_256_xts(), EVP_sha1(), NULL, (unsigned char*)gPassword, strlen(gPassword), 7, gXtsKey, gIV);
+    break;
   }
 
   for (int i = 0; i < numThreads; ++i) {
@@ -351,6 +746,13 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
       EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_128_cbc(), NULL, gKey, gIV);
       status = AES_set_encrypt_key(gKey, 128, &pResult[i].encKey);
       break;
+    case AES192Enc:
+      status = AESNI_set_encrypt_key(gKey, 192, &pResult[i].encKeyAligned);
+      break;
+    case OpenSSL192Enc:
+      EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_192_cbc(), NULL, gKey, gIV);
+      status = AES_set_encrypt_key(gKey, 192, &pResult[i].encKey);
+      break;
     case AES256Enc:
       status = AESNI_set_encrypt_key(gKey, 256, &pResult[i].encKeyAligned);
       break;
@@ -360,19 +762,132 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
       break;
     // DECRYPTION METHODS
     case AES128Dec:
+    case AES128Dec4:
+    case AES128DecSerial:
       status = AESNI_set_decrypt_key(gKey, 128, &pResult[i].decKeyAligned);
       break;
     case OpenSSL128Dec:
       EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_128_cbc(), NULL, gKey, gIV);
       status = AES_set_decrypt_key(gKey, 128, &pResult[i].decKey);
       break;
+    case AES192Dec:
+    case AES192Dec4:
+    case AES192DecSerial:
+      status = AESNI_set_decrypt_key(gKey, 192, &pResult[i].decKeyAligned);
+      break;
+    case OpenSSL192Dec:
+      EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_192_cbc(), NULL, gKey, gIV);
+      status = AES_set_decrypt_key(gKey, 192, &pResult[i].decKey);
+      break;
     case AES256Dec:
+    case AES256Dec4:
+    case AES256DecSerial:
       status = AESNI_set_decrypt_key(gKey, 256, &pResult[i].decKeyAligned);
       break;
     case OpenSSL256Dec:
       EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_256_cbc(), NULL, gKey, gIV);
       status = AES_set_decrypt_key(gKey, 256, &pResult[i].decKey);
       break;
+    // CTR METHODS (nur Schluessel fuer die Verschluesselung)
+    case AES128Ctr:
+    case AES128CtrDec:
+      status = AESNI_set_encrypt_key(gKey, 128, &pResult[i].encKeyAligned);
+      break;
+    case OpenSSL128Ctr:
+    case OpenSSL128CtrDec:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_128_ctr(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case AES192Ctr:
+    case AES192CtrDec:
+      status = AESNI_set_encrypt_key(gKey, 192, &pResult[i].encKeyAligned);
+      break;
+    case OpenSSL192Ctr:
+    case OpenSSL192CtrDec:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_192_ctr(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case AES256Ctr:
+    case AES256CtrDec:
+      status = AESNI_set_encrypt_key(gKey, 256, &pResult[i].encKeyAligned);
+      break;
+    case OpenSSL256Ctr:
+    case OpenSSL256CtrDec:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_256_ctr(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    // GCM METHODS
+    case AES128Gcm:
+    case AES128GcmDec:
+      status = AESNI_gcm_set_key(gKey, 128, &pResult[i].gcmKey);
+      break;
+    case OpenSSL128Gcm:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_128_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case OpenSSL128GcmDec:
+      status = EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_128_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case AES192Gcm:
+    case AES192GcmDec:
+      status = AESNI_gcm_set_key(gKey, 192, &pResult[i].gcmKey);
+      break;
+    case OpenSSL192Gcm:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_192_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case OpenSSL192GcmDec:
+      status = EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_192_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case AES256Gcm:
+    case AES256GcmDec:
+      status = AESNI_gcm_set_key(gKey, 256, &pResult[i].gcmKey);
+      break;
+    case OpenSSL256Gcm:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_256_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    case OpenSSL256GcmDec:
+      status = EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_256_gcm(), NULL, gKey, gIV)? 0 : -1;
+      break;
+    // MULTI-BUFFER METHODS
+    case AES128EncMB:
+    case AES128EncStreams:
+      status = AESNI_set_encrypt_key(gKey, 128, &pResult[i].encKeyAligned);
+      break;
+    case AES128DecStreams:
+      status = AESNI_set_decrypt_key(gKey, 128, &pResult[i].decKeyAligned);
+      break;
+    case AES256EncMB:
+    case AES256EncStreams:
+      status = AESNI_set_encrypt_key(gKey, 256, &pResult[i].encKeyAligned);
+      break;
+    case AES256DecStreams:
+      status = AESNI_set_decrypt_key(gKey, 256, &pResult[i].decKeyAligned);
+      break;
+    // XTS METHODS
+    case AES128Xts:
+      status = AESNI_set_encrypt_key(gXtsKey, 128, &pResult[i].encKeyAligned)
+        | AESNI_set_encrypt_key(gXtsKey + 16, 128, &pResult[i].tweakKeyAligned);
+      break;
+    case AES128XtsDec:
+      status = AESNI_set_decrypt_key(gXtsKey, 128, &pResult[i].decKeyAligned)
+        | AESNI_set_encrypt_key(gXtsKey + 16, 128, &pResult[i].tweakKeyAligned);
+      break;
+    case OpenSSL128Xts:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_128_xts(), NULL, gXtsKey, NULL)? 0 : -1;
+      break;
+    case OpenSSL128XtsDec:
+      status = EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_128_xts(), NULL, gXtsKey, NULL)? 0 : -1;
+      break;
+    case AES256Xts:
+      status = AESNI_set_encrypt_key(gXtsKey, 256, &pResult[i].encKeyAligned)
+        | AESNI_set_encrypt_key(gXtsKey + 32, 256, &pResult[i].tweakKeyAligned);
+      break;
+    case AES256XtsDec:
+      status = AESNI_set_decrypt_key(gXtsKey, 256, &pResult[i].decKeyAligned)
+        | AESNI_set_encrypt_key(gXtsKey + 32, 256, &pResult[i].tweakKeyAligned);
+      break;
+    case OpenSSL256Xts:
+      status = EVP_EncryptInit_ex(pResult[i].encCtx, EVP_aes_256_xts(), NULL, gXtsKey, NULL)? 0 : -1;
+      break;
+    case OpenSSL256XtsDec:
+      status = EVP_DecryptInit_ex(pResult[i].decCtx, EVP_aes_256_xts(), NULL, gXtsKey, NULL)? 0 : -1;
+      break;
     }
     if (status != 0)
       exit(status);
@@ -403,8 +918,12 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
   std::cout << std::setfill(' ') << std::setw(8) << std::dec << (1000*tMin/Stopwatch::RESOLUTION) << " ms  " 
     << std::fixed << std::setprecision(2) << std::setw(8)
     << (float)gBufSize*gIterations/1024/1024/((float)t/Stopwatch::RESOLUTION)*numThreads << " MB/s"
-    << std::setw(8) << (float)pResult[0].ticks / gBufSize
-    << std::endl;
+    << std::setw(8) << (float)pResult[0].ticks / gBufSize;
+  // XTS: so viele Sektoren pro Sekunde koennte ein Volume ver- bzw. entschluesseln
+  if (method & XtsMode)
+    std::cout << std::setw(10) << std::setprecision(0)
+      << (float)gBufSize*gIterations/gSectorSize/((float)t/Stopwatch::RESOLUTION)*numThreads << " IOPS";
+  std::cout << std::endl;
 
   delete [] pResult;
   delete [] hThread;
@@ -430,6 +949,9 @@ void usage(void) {
     << "  (-p|--password) PASSWORD" << std::endl
     << "     Verwenden eines eigenen Passworts zur Verschluesselung statt `" << gPassword << "`" << std::endl
     << std::endl
+    << "  --sector-size N" << std::endl
+    << "     Sektorgroesse fuer XTS in Bytes, ein Vielfaches von 16 (Vorgabe: " << DEFAULT_SECTOR_SIZE << ")" << std::endl
+    << std::endl
     << "  --no-cross" << std::endl
     << "     Verschluesseln mit OpenSSL und Entschluesseln mit AES-NI unterlassen" << std::endl
     << std::endl
@@ -472,6 +994,43 @@ void clearEncDecBufs(void) {
 }
 
 
+// Betriebsart, die OpenSSL und AES-NI mit denselben Schluesseln ver- und
+// entschluesseln (Index 0: OpenSSL, 1: AES-NI)
+struct ModeBenchmark {
+  const char* openssl;
+  const char* intrinsic;
+  Method enc[2];
+  Method dec[2];
+};
+
+// jede Implementierung fuer sich und, falls gewuenscht, ueber Kreuz
+bool runModeBenchmarks(int numThreads, const ModeBenchmark* benchmarks, int count) {
+  bool correct = true;
+  bool ok;
+  for (int j = 0; j < count; ++j) {
+    const ModeBenchmark& b = benchmarks[j];
+    for (int m = 0; m < 2; ++m) {
+      clearEncDecBufs();
+      runBenchmark(numThreads, m == 0? b.openssl : b.intrinsic, b.enc[m]);
+      runBenchmark(numThreads, m == 0? b.openssl : b.intrinsic, b.dec[m]);
+      ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+      correct = correct && ok;
+      std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl;
+    }
+    if (gDoCrosscrypt) {
+      clearEncDecBufs();
+      runBenchmark(numThreads, b.openssl, b.enc[0]);
+      runBenchmark(numThreads, b.intrinsic, b.dec[1]);
+      ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+      correct = correct && ok;
+      std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl;
+    }
+    std::cout << std::endl;
+  }
+  return correct;
+}
+
+
 int main(int argc, char* argv[]) {
 #if defined(WIN32)
   gThreadPriority = GetThreadPriority(GetCurrentThread());
@@ -540,6 +1099,15 @@ int main(int argc, char* argv[]) {
     case SELECT_NO_CROSS_CRYPT:
       gDoCrosscrypt = false;
       break;
+    case SELECT_SECTOR_SIZE:
+      if (optarg == NULL) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      gSectorSize = atoi(optarg);
+      if (gSectorSize < AES_BLOCK_SIZE || gSectorSize % AES_BLOCK_SIZE != 0)
+        gSectorSize = DEFAULT_SECTOR_SIZE;
+      break;
     case 'v':
       ++gVerbose;
       break;
@@ -700,6 +1268,20 @@ int main(int argc, char* argv[]) {
     gBufSize *= 1024*1024;
   }
 
+  // Stroeme von 16 Byte bis 64 KByte Laenge, die den Puffer eines Threads fuellen
+  {
+    uint32_t x = 0x12345678U;
+    int rest = gBufSize;
+    while (rest > 0) {
+      x = x * 1664525U + 1013904223U;
+      int len = AES_BLOCK_SIZE * (1 + (int)((x >> 16) % 4096));
+      if (len > rest)
+        len = rest;
+      gStreamLengths.push_back(len);
+      rest -= len;
+    }
+  }
+
   try {
     gPlainBuf = (unsigned char*)_aligned_malloc(gMaxNumThreads * (gBufSize + AES_BLOCK_SIZE), AES_BLOCK_SIZE);
     gEncBuf   = (unsigned char*)_aligned_malloc(gMaxNumThreads * (gBufSize + AES_BLOCK_SIZE), AES_BLOCK_SIZE);
@@ -735,7 +1317,8 @@ int main(int argc, char* argv[]) {
 #if defined(WIN32)
   SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 #endif
-  bool correct = false;
+  bool correct = true;
+  bool ok;
   std::cout << "Ver- und Entschluesselung (" << gIterations << "x" << (gBufSize/1024/1024) << " MByte) ..." << std::endl;
   for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 ; ++i) {
     const int numThreads = gNumThreads[i];
@@ -748,54 +1331,154 @@ int main(int argc, char* argv[]) {
     clearEncDecBufs();
     runBenchmark(numThreads, "AES128 (OpenSSL)", OpenSSL128Enc);
     runBenchmark(numThreads, "AES128 (OpenSSL)", OpenSSL128Dec);
-    correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-    std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+    ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+    correct = correct && ok;
+    std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
     // writeEncBuf("aes-128-openssl");
 
     clearEncDecBufs();
     runBenchmark(numThreads, "AES256 (OpenSSL)", OpenSSL256Enc);
     runBenchmark(numThreads, "AES256 (OpenSSL)", OpenSSL256Dec);
-    correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-    std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+    ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+    correct = correct && ok;
+    std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
     if (CPUFeatures::instance().isAESSupported()) {
       clearEncDecBufs();
       runBenchmark(numThreads, "AES128 (Intrinsic)", AES128Enc);
       runBenchmark(numThreads, "AES128 (Intrinsic)", AES128Dec);
-      correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-      std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+      ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+      correct = correct && ok;
+      std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
       clearEncDecBufs();
       runBenchmark(numThreads, "AES256 (Intrinsic)", AES256Enc);
       runBenchmark(numThreads, "AES256 (Intrinsic)", AES256Dec);
-      correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-      std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+      ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+      correct = correct && ok;
+      std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
       if (gDoCrosscrypt) {
         clearEncDecBufs();
         runBenchmark(numThreads, "AES128 (OpenSSL)", OpenSSL128Enc);
         runBenchmark(numThreads, "AES128 (Intrinsic)", AES128Dec);
-        correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-        std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+        ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+        correct = correct && ok;
+        std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
         clearEncDecBufs();
         runBenchmark(numThreads, "AES256 (OpenSSL)", OpenSSL256Enc);
         runBenchmark(numThreads, "AES256 (Intrinsic)", AES256Dec);
-        correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-        std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+        ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+        correct = correct && ok;
+        std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
         clearEncDecBufs();
         runBenchmark(numThreads, "AES128 (Intrinsic)", AES128Enc);
         runBenchmark(numThreads, "AES128 (OpenSSL)", OpenSSL128Dec);
-        correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-        std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+        ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+        correct = correct && ok;
+        std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
 
         clearEncDecBufs();
         runBenchmark(numThreads, "AES256 (Intrinsic)", AES256Enc);
         runBenchmark(numThreads, "AES256 (OpenSSL)", OpenSSL256Dec);
-        correct = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
-        std::cout << "  " << (correct? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+        ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+        correct = correct && ok;
+        std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl << std::endl;
+      }
+
+      // CBC-Entschluesselung: OpenSSL gegen einen, 4 und 8 Bloecke parallel
+      struct DecryptBenchmark {
+        const char* name;
+        Method enc;
+        Method dec[4];
+      };
+      static const DecryptBenchmark DECRYPT_BENCHMARKS[] = {
+        { "AES128", OpenSSL128Enc, { OpenSSL128Dec, AES128DecSerial, AES128Dec4, AES128Dec } },
+        { "AES192", OpenSSL192Enc, { OpenSSL192Dec, AES192DecSerial, AES192Dec4, AES192Dec } },
+        { "AES256", OpenSSL256Enc, { OpenSSL256Dec, AES256DecSerial, AES256Dec4, AES256Dec } }
+      };
+      static const char* DECRYPT_VARIANTS[4] = { " (OpenSSL)", " (1 Block)", " (4 Bloecke)", " (8 Bloecke)" };
+      for (int j = 0; j < 3; ++j) {
+        const DecryptBenchmark& b = DECRYPT_BENCHMARKS[j];
+        clearEncDecBufs();
+        runBenchmark(numThreads, (std::string(b.name) + DECRYPT_VARIANTS[0]).c_str(), b.enc);
+        for (int m = 0; m < 4; ++m) {
+          // nur den Klartext loeschen, das Chiffrat wird weiter gebraucht
+          memset(gDecBuf, 0, gMaxNumThreads * gBufSize);
+          runBenchmark(numThreads, (std::string(b.name) + DECRYPT_VARIANTS[m]).c_str(), b.dec[m]);
+          ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+          correct = correct && ok;
+          std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl;
+        }
+        std::cout << std::endl;
+      }
+
+      // CTR-Modus: OpenSSL gegen AES-NI mit 8 Bloecken parallel
+      static const ModeBenchmark CTR_BENCHMARKS[] = {
+        { "CTR128 (OpenSSL)", "CTR128 (Intrinsic)", { OpenSSL128Ctr, AES128Ctr }, { OpenSSL128CtrDec, AES128CtrDec } },
+        { "CTR192 (OpenSSL)", "CTR192 (Intrinsic)", { OpenSSL192Ctr, AES192Ctr }, { OpenSSL192CtrDec, AES192CtrDec } },
+        { "CTR256 (OpenSSL)", "CTR256 (Intrinsic)", { OpenSSL256Ctr, AES256Ctr }, { OpenSSL256CtrDec, AES256CtrDec } }
+      };
+      correct = runModeBenchmarks(numThreads, CTR_BENCHMARKS, 3) && correct;
+
+      // GCM: OpenSSL gegen AES-NI mit PCLMULQDQ
+      if (CPUFeatures::instance().isClmulSupported()) {
+        static const ModeBenchmark GCM_BENCHMARKS[] = {
+          { "GCM128 (OpenSSL)", "GCM128 (Intrinsic)", { OpenSSL128Gcm, AES128Gcm }, { OpenSSL128GcmDec, AES128GcmDec } },
+          { "GCM192 (OpenSSL)", "GCM192 (Intrinsic)", { OpenSSL192Gcm, AES192Gcm }, { OpenSSL192GcmDec, AES192GcmDec } },
+          { "GCM256 (OpenSSL)", "GCM256 (Intrinsic)", { OpenSSL256Gcm, AES256Gcm }, { OpenSSL256GcmDec, AES256GcmDec } }
+        };
+        correct = runModeBenchmarks(numThreads, GCM_BENCHMARKS, 3) && correct;
+      }
+
+      // XTS: Sektor fuer Sektor mit OpenSSL gegen alle Sektoren eines
+      // Puffers in einem Aufruf mit AES-NI
+      std::cout << "  XTS mit " << gSectorSize << " Byte grossen Sektoren:" << std::endl;
+      static const ModeBenchmark XTS_BENCHMARKS[] = {
+        { "XTS128 (OpenSSL)", "XTS128 (Intrinsic)", { OpenSSL128Xts, AES128Xts }, { OpenSSL128XtsDec, AES128XtsDec } },
+        { "XTS256 (OpenSSL)", "XTS256 (Intrinsic)", { OpenSSL256Xts, AES256Xts }, { OpenSSL256XtsDec, AES256XtsDec } }
+      };
+      correct = runModeBenchmarks(numThreads, XTS_BENCHMARKS, 2) && correct;
+
+      // Multi-Buffer-CBC: die Stroeme nacheinander bzw. je 8 gleichzeitig
+      // verschluesseln, entschluesselt wird Strom fuer Strom; zusaetzlich
+      // mit nur drei Stroemen, bei denen die meisten Lanes leer bleiben
+      // und die letzten ein, zwei Stroeme seriell zu Ende laufen
+      const std::vector<int> manyStreams = gStreamLengths;
+      std::vector<int> fewStreams;
+      fewStreams.push_back(AES_BLOCK_SIZE * (gBufSize / 2 / AES_BLOCK_SIZE));
+      fewStreams.push_back(AES_BLOCK_SIZE * (gBufSize / 3 / AES_BLOCK_SIZE));
+      fewStreams.push_back(gBufSize - fewStreams[0] - fewStreams[1]);
+      const std::vector<int>* STREAM_SETS[] = { &manyStreams, &fewStreams };
+      struct MultiBufferBenchmark {
+        const char* name;
+        Method enc;
+        Method dec;
+      };
+      static const MultiBufferBenchmark MB_BENCHMARKS[] = {
+        { "AES128 (1 Strom)", AES128EncStreams, AES128DecStreams },
+        { "AES128 (8 Stroeme)", AES128EncMB, AES128DecStreams },
+        { "AES256 (1 Strom)", AES256EncStreams, AES256DecStreams },
+        { "AES256 (8 Stroeme)", AES256EncMB, AES256DecStreams }
+      };
+      for (int s = 0; s < 2; ++s) {
+        gStreamLengths = *STREAM_SETS[s];
+        std::cout << "  CBC mit " << gStreamLengths.size() << " unabhaengigen Stroemen:" << std::endl;
+        for (int j = 0; j < 4; ++j) {
+          const MultiBufferBenchmark& b = MB_BENCHMARKS[j];
+          clearEncDecBufs();
+          runBenchmark(numThreads, b.name, b.enc);
+          runBenchmark(numThreads, b.name, b.dec);
+          ok = memcmp(gPlainBuf, gDecBuf, gBufSize) == 0;
+          correct = correct && ok;
+          std::cout << "  " << (ok? "OK." : ">>>FAIL<<<") << std::endl;
+          if (j % 2 == 1)
+            std::cout << std::endl;
+        }
       }
+      gStreamLengths = manyStreams;
     }
   }
 
@@ -3,8 +3,11 @@
 // All rights reserved.
 
 #include <wmmintrin.h>
+#include <smmintrin.h>
 #include <stdint.h>
+#include <string.h>
 #include <assert.h>
+#include <algorithm>
 #include "aesni.h"
 
 #ifndef NULL
@@ -89,8 +92,7 @@ void AES_192_Key_Expansion(const unsigned char* userkey, unsigned char* key)
 {
   assert(userkey != NULL);
   assert(key != NULL);
-#if defined(USE_AES_192)
-  __m128i temp1, temp2, temp3, temp4;
+  __m128i temp1, temp2, temp3;
   __m128i *Key_Schedule = (__m128i*)key;
   temp1 = _mm_loadu_si128((__m128i*)userkey);
   temp3 = _mm_loadu_si128((__m128i*)(userkey+16));
@@ -98,39 +100,35 @@ void AES_192_Key_Expansion(const unsigned char* userkey, unsigned char* key)
   Key_Schedule[1] = temp3;
   temp2 = _mm_aeskeygenassist_si128(temp3, 0x1);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
-  Key_Schedule[1] = (__m128i)_mm_shuffle_pd((__m128d)Key_Schedule[1], (__m128d)temp1, 0);
-  Key_Schedule[2] = (__m128i)_mm_shuffle_pd((__m128d)temp1, (__m128d)temp3, 1);
+  Key_Schedule[1] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(Key_Schedule[1]), _mm_castsi128_pd(temp1), 0));
+  Key_Schedule[2] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(temp1), _mm_castsi128_pd(temp3), 1));
   temp2 = _mm_aeskeygenassist_si128(temp3,0x2);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
   Key_Schedule[3] = temp1;
   Key_Schedule[4] = temp3;
   temp2 = _mm_aeskeygenassist_si128(temp3,0x4);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
-  Key_Schedule[4] = (__m128i)_mm_shuffle_pd((__m128d)Key_Schedule[4], (__m128d)temp1, 0);
-  Key_Schedule[5] = (__m128i)_mm_shuffle_pd((__m128d)temp1, (__m128d)temp3, 1);
+  Key_Schedule[4] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(Key_Schedule[4]), _mm_castsi128_pd(temp1), 0));
+  Key_Schedule[5] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(temp1), _mm_castsi128_pd(temp3), 1));
   temp2 = _mm_aeskeygenassist_si128(temp3,0x8);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
   Key_Schedule[6]=temp1;
   Key_Schedule[7]=temp3;
   temp2 = _mm_aeskeygenassist_si128(temp3,0x10);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
-  Key_Schedule[7] = (__m128i)_mm_shuffle_pd((__m128d)Key_Schedule[7], (__m128d)temp1, 0);
-  Key_Schedule[8] = (__m128i)_mm_shuffle_pd((__m128d)temp1, (__m128d)temp3, 1);
+  Key_Schedule[7] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(Key_Schedule[7]), _mm_castsi128_pd(temp1), 0));
+  Key_Schedule[8] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(temp1), _mm_castsi128_pd(temp3), 1));
   temp2 = _mm_aeskeygenassist_si128 (temp3,0x20);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
   Key_Schedule[9]=temp1;
   Key_Schedule[10]=temp3;
   temp2 = _mm_aeskeygenassist_si128 (temp3,0x40);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
-  Key_Schedule[10] = (__m128i)_mm_shuffle_pd((__m128d)Key_Schedule[10], (__m128d)temp1, 0);
-  Key_Schedule[11] = (__m128i)_mm_shuffle_pd((__m128d)temp1, (__m128d)temp3, 1);
+  Key_Schedule[10] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(Key_Schedule[10]), _mm_castsi128_pd(temp1), 0));
+  Key_Schedule[11] = _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(temp1), _mm_castsi128_pd(temp3), 1));
   temp2 = _mm_aeskeygenassist_si128 (temp3,0x80);
   KEY_192_ASSIST(&temp1, &temp2, &temp3);
   Key_Schedule[12] = temp1;
-#else
-  (void)userkey;
-  (void)key;
-#endif
 }
 
 inline void KEY_256_ASSIST_1(__m128i* temp1, __m128i* temp2)
@@ -340,9 +338,9 @@ void AESNI_cbc_encrypt(const unsigned char* in, unsigned char* out,
   }
 }
 
-void AESNI_cbc_decrypt(const unsigned char* in, unsigned char* out,
-                       unsigned char ivec[16], unsigned long length,
-                       AES_KEY_ALIGNED* key)
+void AESNI_cbc_decrypt_serial(const unsigned char* in, unsigned char* out,
+                              unsigned char ivec[16], unsigned long length,
+                              AES_KEY_ALIGNED* key)
 {
   assert(key->rounds == 10 ||  key->rounds == 12 ||  key->rounds == 14);
   length = (length % 16)? length / 16 + 1 : length / 16;
@@ -417,3 +415,1109 @@ void AESNI_cbc_decrypt(const unsigned char* in, unsigned char* out,
     break;
   }
 }
+
+
+// Beim Entschluesseln im CBC-Modus haengt kein Block vom Ergebnis eines
+// anderen ab: Klartext[i] = Dec(Chiffrat[i]) ^ Chiffrat[i-1]. Deshalb
+// koennen mehrere Bloecke gleichzeitig die Runden durchlaufen; so verdeckt
+// die CPU die Latenz von AESDEC (4 bis 7 Takte) mit den Befehlen fuer
+// die uebrigen Bloecke. Jeder Block steht in einer eigenen Variablen,
+// damit der Compiler sie auch ohne Ausrollen in Registern haelt.
+template <int ROUNDS>
+inline void CBC_decrypt_8(const __m128i*& enc, __m128i*& dec, __m128i& feedback, const __m128i* k)
+{
+  const __m128i in0 = _mm_loadu_si128(enc + 0);
+  const __m128i in1 = _mm_loadu_si128(enc + 1);
+  const __m128i in2 = _mm_loadu_si128(enc + 2);
+  const __m128i in3 = _mm_loadu_si128(enc + 3);
+  const __m128i in4 = _mm_loadu_si128(enc + 4);
+  const __m128i in5 = _mm_loadu_si128(enc + 5);
+  const __m128i in6 = _mm_loadu_si128(enc + 6);
+  const __m128i in7 = _mm_loadu_si128(enc + 7);
+  __m128i d0 = _mm_xor_si128(in0, k[0]);
+  __m128i d1 = _mm_xor_si128(in1, k[0]);
+  __m128i d2 = _mm_xor_si128(in2, k[0]);
+  __m128i d3 = _mm_xor_si128(in3, k[0]);
+  __m128i d4 = _mm_xor_si128(in4, k[0]);
+  __m128i d5 = _mm_xor_si128(in5, k[0]);
+  __m128i d6 = _mm_xor_si128(in6, k[0]);
+  __m128i d7 = _mm_xor_si128(in7, k[0]);
+  for (int r = 1; r < ROUNDS; ++r) {
+    const __m128i kr = k[r];
+    d0 = _mm_aesdec_si128(d0, kr);
+    d1 = _mm_aesdec_si128(d1, kr);
+    d2 = _mm_aesdec_si128(d2, kr);
+    d3 = _mm_aesdec_si128(d3, kr);
+    d4 = _mm_aesdec_si128(d4, kr);
+    d5 = _mm_aesdec_si128(d5, kr);
+    d6 = _mm_aesdec_si128(d6, kr);
+    d7 = _mm_aesdec_si128(d7, kr);
+  }
+  _mm_storeu_si128(dec + 0, _mm_xor_si128(_mm_aesdeclast_si128(d0, k[ROUNDS]), feedback));
+  _mm_storeu_si128(dec + 1, _mm_xor_si128(_mm_aesdeclast_si128(d1, k[ROUNDS]), in0));
+  _mm_storeu_si128(dec + 2, _mm_xor_si128(_mm_aesdeclast_si128(d2, k[ROUNDS]), in1));
+  _mm_storeu_si128(dec + 3, _mm_xor_si128(_mm_aesdeclast_si128(d3, k[ROUNDS]), in2));
+  _mm_storeu_si128(dec + 4, _mm_xor_si128(_mm_aesdeclast_si128(d4, k[ROUNDS]), in3));
+  _mm_storeu_si128(dec + 5, _mm_xor_si128(_mm_aesdeclast_si128(d5, k[ROUNDS]), in4));
+  _mm_storeu_si128(dec + 6, _mm_xor_si128(_mm_aesdeclast_si128(d6, k[ROUNDS]), in5));
+  _mm_storeu_si128(dec + 7, _mm_xor_si128(_mm_aesdeclast_si128(d7, k[ROUNDS]), in6));
+  feedback = in7;
+  enc += 8;
+  dec += 8;
+}
+
+template <int ROUNDS>
+inline void CBC_decrypt_4(const __m128i*& enc, __m128i*& dec, __m128i& feedback, const __m128i* k)
+{
+  const __m128i in0 = _mm_loadu_si128(enc + 0);
+  const __m128i in1 = _mm_loadu_si128(enc + 1);
+  const __m128i in2 = _mm_loadu_si128(enc + 2);
+  const __m128i in3 = _mm_loadu_si128(enc + 3);
+  __m128i d0 = _mm_xor_si128(in0, k[0]);
+  __m128i d1 = _mm_xor_si128(in1, k[0]);
+  __m128i d2 = _mm_xor_si128(in2, k[0]);
+  __m128i d3 = _mm_xor_si128(in3, k[0]);
+  for (int r = 1; r < ROUNDS; ++r) {
+    const __m128i kr = k[r];
+    d0 = _mm_aesdec_si128(d0, kr);
+    d1 = _mm_aesdec_si128(d1, kr);
+    d2 = _mm_aesdec_si128(d2, kr);
+    d3 = _mm_aesdec_si128(d3, kr);
+  }
+  _mm_storeu_si128(dec + 0, _mm_xor_si128(_mm_aesdeclast_si128(d0, k[ROUNDS]), feedback));
+  _mm_storeu_si128(dec + 1, _mm_xor_si128(_mm_aesdeclast_si128(d1, k[ROUNDS]), in0));
+  _mm_storeu_si128(dec + 2, _mm_xor_si128(_mm_aesdeclast_si128(d2, k[ROUNDS]), in1));
+  _mm_storeu_si128(dec + 3, _mm_xor_si128(_mm_aesdeclast_si128(d3, k[ROUNDS]), in2));
+  feedback = in3;
+  enc += 4;
+  dec += 4;
+}
+
+template <int ROUNDS>
+inline void CBC_decrypt_1(const __m128i*& enc, __m128i*& dec, __m128i& feedback, const __m128i* k)
+{
+  const __m128i in0 = _mm_loadu_si128(enc);
+  __m128i d0 = _mm_xor_si128(in0, k[0]);
+  for (int r = 1; r < ROUNDS; ++r)
+    d0 = _mm_aesdec_si128(d0, k[r]);
+  _mm_storeu_si128(dec, _mm_xor_si128(_mm_aesdeclast_si128(d0, k[ROUNDS]), feedback));
+  feedback = in0;
+  ++enc;
+  ++dec;
+}
+
+// LANES (4 oder 8) Bloecke auf einmal, den Rest erst zu viert, dann einzeln
+template <int ROUNDS, int LANES>
+void CBC_decrypt(const unsigned char* in, unsigned char* out,
+                 const unsigned char ivec[16], unsigned long blocks,
+                 const __m128i* k)
+{
+  const __m128i* enc = (const __m128i*)in;
+  const __m128i* const encEnd = enc + blocks;
+  __m128i* dec = (__m128i*)out;
+  __m128i feedback = _mm_loadu_si128((const __m128i*)ivec);
+  if (LANES == 8) {
+    while (encEnd - enc >= 8)
+      CBC_decrypt_8<ROUNDS>(enc, dec, feedback, k);
+  }
+  while (encEnd - enc >= 4)
+    CBC_decrypt_4<ROUNDS>(enc, dec, feedback, k);
+  while (enc < encEnd)
+    CBC_decrypt_1<ROUNDS>(enc, dec, feedback, k);
+}
+
+template <int LANES>
+void CBC_decrypt(const unsigned char* in, unsigned char* out,
+                 unsigned char ivec[16], unsigned long length,
+                 AES_KEY_ALIGNED* key)
+{
+  assert(key->rounds == 10 || key->rounds == 12 || key->rounds == 14);
+  const unsigned long blocks = (length % 16)? length / 16 + 1 : length / 16;
+  const __m128i* const k = (__m128i*)key->rd_key;
+  switch (key->rounds) {
+  case 10:
+    CBC_decrypt<10, LANES>(in, out, ivec, blocks, k);
+    break;
+  case 12:
+    CBC_decrypt<12, LANES>(in, out, ivec, blocks, k);
+    break;
+  case 14:
+    CBC_decrypt<14, LANES>(in, out, ivec, blocks, k);
+    break;
+  }
+}
+
+void AESNI_cbc_decrypt(const unsigned char* in, unsigned char* out,
+                       unsigned char ivec[16], unsigned long length,
+                       AES_KEY_ALIGNED* key)
+{
+  CBC_decrypt<8>(in, out, ivec, length, key);
+}
+
+void AESNI_cbc_decrypt4(const unsigned char* in, unsigned char* out,
+                        unsigned char ivec[16], unsigned long length,
+                        AES_KEY_ALIGNED* key)
+{
+  CBC_decrypt<4>(in, out, ivec, length, key);
+}
+
+
+// Die Zaehler stehen in umgekehrter Bytereihenfolge in den Registern,
+// so dass der niederwertige 64-Bit-Teil vorn liegt und sich mit PADDQ
+// erhoehen laesst. Erst fuer AESENC werden die Bytes mit PSHUFB
+// zurueck in die Big-Endian-Reihenfolge von ivec gebracht.
+inline __m128i CTR_byteswap(__m128i x)
+{
+  return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+// 128-Bit-Zaehler um 1 erhoehen: Ist der niederwertige Teil danach 0,
+// ist ein Uebertrag in den hoeherwertigen Teil faellig. PCMPEQQ liefert
+// dann -1, das, in die hoeherwertige Haelfte geschoben, abgezogen wird.
+inline __m128i CTR_increment(__m128i ctr)
+{
+  ctr = _mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 1));
+  const __m128i carry = _mm_cmpeq_epi64(ctr, _mm_setzero_si128());
+  return _mm_sub_epi64(ctr, _mm_slli_si128(carry, 8));
+}
+
+template <int ROUNDS>
+inline __m128i CTR_encrypt_block(__m128i data, const __m128i* k)
+{
+  data = _mm_xor_si128(data, k[0]);
+  for (int r = 1; r < ROUNDS; ++r)
+    data = _mm_aesenc_si128(data, k[r]);
+  return _mm_aesenclast_si128(data, k[ROUNDS]);
+}
+
+// 8 Zaehlerbloecke gleichzeitig verschluesseln und mit der Eingabe verknuepfen
+template <int ROUNDS>
+inline void CTR_crypt_8(const __m128i*& in, __m128i*& out, __m128i& ctr, const __m128i* k)
+{
+  __m128i d0, d1, d2, d3, d4, d5, d6, d7;
+  uint64_t lo;
+  _mm_storel_epi64((__m128i*)&lo, ctr);
+  if (lo <= ~(uint64_t)0 - 8) {
+    // kein Uebertrag in den naechsten 8 Bloecken: die Zaehler haengen nicht
+    // voneinander ab und lassen sich parallel berechnen
+    d0 = CTR_byteswap(ctr);
+    d1 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 1)));
+    d2 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 2)));
+    d3 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 3)));
+    d4 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 4)));
+    d5 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 5)));
+    d6 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 6)));
+    d7 = CTR_byteswap(_mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 7)));
+    ctr = _mm_add_epi64(ctr, _mm_set_epi32(0, 0, 0, 8));
+  }
+  else {
+    d0 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d1 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d2 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d3 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d4 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d5 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d6 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+    d7 = CTR_byteswap(ctr);
+    ctr = CTR_increment(ctr);
+  }
+  d0 = _mm_xor_si128(d0, k[0]);
+  d1 = _mm_xor_si128(d1, k[0]);
+  d2 = _mm_xor_si128(d2, k[0]);
+  d3 = _mm_xor_si128(d3, k[0]);
+  d4 = _mm_xor_si128(d4, k[0]);
+  d5 = _mm_xor_si128(d5, k[0]);
+  d6 = _mm_xor_si128(d6, k[0]);
+  d7 = _mm_xor_si128(d7, k[0]);
+  for (int r = 1; r < ROUNDS; ++r) {
+    const __m128i kr = k[r];
+    d0 = _mm_aesenc_si128(d0, kr);
+    d1 = _mm_aesenc_si128(d1, kr);
+    d2 = _mm_aesenc_si128(d2, kr);
+    d3 = _mm_aesenc_si128(d3, kr);
+    d4 = _mm_aesenc_si128(d4, kr);
+    d5 = _mm_aesenc_si128(d5, kr);
+    d6 = _mm_aesenc_si128(d6, kr);
+    d7 = _mm_aesenc_si128(d7, kr);
+  }
+  _mm_storeu_si128(out + 0, _mm_xor_si128(_mm_aesenclast_si128(d0, k[ROUNDS]), _mm_loadu_si128(in + 0)));
+  _mm_storeu_si128(out + 1, _mm_xor_si128(_mm_aesenclast_si128(d1, k[ROUNDS]), _mm_loadu_si128(in + 1)));
+  _mm_storeu_si128(out + 2, _mm_xor_si128(_mm_aesenclast_si128(d2, k[ROUNDS]), _mm_loadu_si128(in + 2)));
+  _mm_storeu_si128(out + 3, _mm_xor_si128(_mm_aesenclast_si128(d3, k[ROUNDS]), _mm_loadu_si128(in + 3)));
+  _mm_storeu_si128(out + 4, _mm_xor_si128(_mm_aesenclast_si128(d4, k[ROUNDS]), _mm_loadu_si128(in + 4)));
+  _mm_storeu_si128(out + 5, _mm_xor_si128(_mm_aesenclast_si128(d5, k[ROUNDS]), _mm_loadu_si128(in + 5)));
+  _mm_storeu_si128(out + 6, _mm_xor_si128(_mm_aesenclast_si128(d6, k[ROUNDS]), _mm_loadu_si128(in + 6)));
+  _mm_storeu_si128(out + 7, _mm_xor_si128(_mm_aesenclast_si128(d7, k[ROUNDS]), _mm_loadu_si128(in + 7)));
+  in += 8;
+  out += 8;
+}
+
+template <int ROUNDS>
+void CTR_crypt(const unsigned char* in, unsigned char* out, unsigned long length,
+               const __m128i* k, unsigned char ivec[16],
+               unsigned char ecount_buf[16], unsigned int* num)
+{
+  unsigned int n = *num;
+  // Rest des angebrochenen Schluesselstromblocks
+  while (n != 0 && length > 0) {
+    *out++ = *in++ ^ ecount_buf[n];
+    n = (n + 1) % 16;
+    --length;
+  }
+  __m128i ctr = CTR_byteswap(_mm_loadu_si128((const __m128i*)ivec));
+  const __m128i* src = (const __m128i*)in;
+  __m128i* dst = (__m128i*)out;
+  const __m128i* const srcEnd = src + length / 16;
+  while (srcEnd - src >= 8)
+    CTR_crypt_8<ROUNDS>(src, dst, ctr, k);
+  while (src < srcEnd) {
+    const __m128i ks = CTR_encrypt_block<ROUNDS>(CTR_byteswap(ctr), k);
+    _mm_storeu_si128(dst++, _mm_xor_si128(ks, _mm_loadu_si128(src++)));
+    ctr = CTR_increment(ctr);
+  }
+  // angebrochener letzter Block: Schluesselstrom fuer den naechsten Aufruf merken
+  length %= 16;
+  if (length > 0) {
+    _mm_storeu_si128((__m128i*)ecount_buf, CTR_encrypt_block<ROUNDS>(CTR_byteswap(ctr), k));
+    ctr = CTR_increment(ctr);
+    in = (const unsigned char*)src;
+    out = (unsigned char*)dst;
+    while (length-- > 0) {
+      out[n] = in[n] ^ ecount_buf[n];
+      ++n;
+    }
+  }
+  _mm_storeu_si128((__m128i*)ivec, CTR_byteswap(ctr));
+  *num = n;
+}
+
+void AESNI_ctr_crypt(const unsigned char* in, unsigned char* out,
+                     unsigned long length, AES_KEY_ALIGNED* key,
+                     unsigned char ivec[16], unsigned char ecount_buf[16],
+                     unsigned int* num)
+{
+  assert(key->rounds == 10 || key->rounds == 12 || key->rounds == 14);
+  assert(*num < 16);
+  const __m128i* const k = (__m128i*)key->rd_key;
+  switch (key->rounds) {
+  case 10:
+    CTR_crypt<10>(in, out, length, k, ivec, ecount_buf, num);
+    break;
+  case 12:
+    CTR_crypt<12>(in, out, length, k, ivec, ecount_buf, num);
+    break;
+  case 14:
+    CTR_crypt<14>(in, out, length, k, ivec, ecount_buf, num);
+    break;
+  }
+}
+
+void AESNI_ctr_seek(const unsigned char iv[16], uint64_t offset,
+                    AES_KEY_ALIGNED* key, unsigned char ivec[16],
+                    unsigned char ecount_buf[16], unsigned int* num)
+{
+  // ivec = iv + offset / 16 (Big Endian)
+  uint64_t add = offset / 16;
+  for (int i = 15; i >= 0; --i) {
+    add += iv[i];
+    ivec[i] = (unsigned char)add;
+    add >>= 8;
+  }
+  *num = (unsigned int)(offset % 16);
+  if (*num != 0) {
+    // wie nach einem Aufruf von AESNI_ctr_crypt(), der mitten im Block
+    // endete: ecount_buf enthaelt den Schluesselstrom zum Zaehler ivec,
+    // ivec zeigt auf den naechsten
+    static const unsigned char ZERO[16] = { 0 };
+    unsigned char unused[16];
+    unsigned int n = 0;
+    AESNI_ctr_crypt(ZERO, ecount_buf, 16, key, ivec, unused, &n);
+  }
+}
+
+
+// GCM: CTR-Verschluesselung mit 32-Bit-Zaehler plus GHASH ueber AAD und
+// Chiffrat. GHASH rechnet wie in Intels Whitepaper "Intel Carry-Less
+// Multiplication Instruction and its Usage for Computing the GCM Mode"
+// mit byteweise gespiegelten Bloecken (CTR_byteswap()); die Bits bleiben
+// gespiegelt, das gleicht GHASH_reduce() mit einer Verschiebung um 1 Bit aus.
+// Weil Multiplikation und Reduktion linear sind, werden bis zu 8 Bloecke
+// mit H^8 ... H^1 multipliziert, aufsummiert und erst dann einmal reduziert:
+// Y' = (Y + X1) * H^n + X2 * H^(n-1) + ... + Xn * H
+
+// a * h (Karatsuba, 3 PCLMULQDQ) ohne Reduktion zu lo, mid und hi addieren;
+// hk enthaelt in den unteren 64 Bit die XOR-Summe der beiden Haelften von h
+inline void GHASH_mul_acc(__m128i a, __m128i h, __m128i hk, __m128i& lo, __m128i& mid, __m128i& hi)
+{
+  lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, h, 0x00));
+  hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, h, 0x11));
+  const __m128i ak = _mm_xor_si128(a, _mm_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)));
+  mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(ak, hk, 0x00));
+}
+
+// 256-Bit-Produkt aus GHASH_mul_acc() um 1 Bit nach links schieben und
+// modulo x^128 + x^7 + x^2 + x + 1 reduzieren
+inline __m128i GHASH_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+  mid = _mm_xor_si128(mid, _mm_xor_si128(lo, hi));
+  lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+  hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+  // hi:lo um 1 Bit nach links
+  __m128i t0 = _mm_srli_epi32(lo, 31);
+  __m128i t1 = _mm_srli_epi32(hi, 31);
+  lo = _mm_slli_epi32(lo, 1);
+  hi = _mm_slli_epi32(hi, 1);
+  const __m128i t2 = _mm_srli_si128(t0, 12);
+  t1 = _mm_slli_si128(t1, 4);
+  t0 = _mm_slli_si128(t0, 4);
+  lo = _mm_or_si128(lo, t0);
+  hi = _mm_or_si128(hi, _mm_or_si128(t1, t2));
+  // erste Phase der Reduktion
+  t0 = _mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_xor_si128(_mm_slli_epi32(lo, 30), _mm_slli_epi32(lo, 25)));
+  t1 = _mm_srli_si128(t0, 4);
+  lo = _mm_xor_si128(lo, _mm_slli_si128(t0, 12));
+  // zweite Phase
+  t0 = _mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_xor_si128(_mm_srli_epi32(lo, 2), _mm_srli_epi32(lo, 7)));
+  lo = _mm_xor_si128(lo, _mm_xor_si128(t0, t1));
+  return _mm_xor_si128(hi, lo);
+}
+
+inline __m128i GHASH_karatsuba_key(__m128i h)
+{
+  return _mm_xor_si128(h, _mm_shuffle_epi32(h, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+inline __m128i GHASH_mul(__m128i a, __m128i h)
+{
+  __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+  GHASH_mul_acc(a, h, GHASH_karatsuba_key(h), lo, mid, hi);
+  return GHASH_reduce(lo, mid, hi);
+}
+
+// blocks volle Bloecke in y einrechnen, bis zu 8 je Reduktion
+__m128i GHASH_blocks(__m128i y, const unsigned char* data, unsigned long blocks, const AES_GCM_KEY* key)
+{
+  const __m128i* const h = (const __m128i*)key->htable;
+  const __m128i* const hk = (const __m128i*)key->hkara;
+  const __m128i* src = (const __m128i*)data;
+  while (blocks > 0) {
+    const int n = (blocks < 8)? (int)blocks : 8;
+    __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    GHASH_mul_acc(_mm_xor_si128(y, CTR_byteswap(_mm_loadu_si128(src))), h[n - 1], hk[n - 1], lo, mid, hi);
+    for (int j = 1; j < n; ++j)
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(src + j)), h[n - 1 - j], hk[n - 1 - j], lo, mid, hi);
+    y = GHASH_reduce(lo, mid, hi);
+    src += n;
+    blocks -= n;
+  }
+  return y;
+}
+
+// length Bytes in y einrechnen, den letzten Block mit Nullen aufgefuellt
+__m128i GHASH_update(__m128i y, const unsigned char* data, unsigned long length, const AES_GCM_KEY* key)
+{
+  y = GHASH_blocks(y, data, length / 16, key);
+  if (length % 16 != 0) {
+    ALIGN16 unsigned char last[16] = { 0 };
+    memcpy(last, data + length - length % 16, length % 16);
+    y = GHASH_blocks(y, last, 1, key);
+  }
+  return y;
+}
+
+inline void GCM_round_8(__m128i& d0, __m128i& d1, __m128i& d2, __m128i& d3,
+                        __m128i& d4, __m128i& d5, __m128i& d6, __m128i& d7, const __m128i kr)
+{
+  d0 = _mm_aesenc_si128(d0, kr);
+  d1 = _mm_aesenc_si128(d1, kr);
+  d2 = _mm_aesenc_si128(d2, kr);
+  d3 = _mm_aesenc_si128(d3, kr);
+  d4 = _mm_aesenc_si128(d4, kr);
+  d5 = _mm_aesenc_si128(d5, kr);
+  d6 = _mm_aesenc_si128(d6, kr);
+  d7 = _mm_aesenc_si128(d7, kr);
+}
+
+// CTR-Teil von GCM. ctr ist der gespiegelte Zaehler des ersten Blocks,
+// y der GHASH-Stand nach der AAD. Je 8 Bloecke laufen die AES-Runden und
+// die GHASH-Multiplikationen verschraenkt: In Runde r wird Block r-1 in
+// GHASH eingerechnet, beim Entschluesseln aus dem aktuellen, beim
+// Verschluesseln aus dem vorigen Chiffrat. Die Reduktion laeuft parallel
+// zu Runde 9.
+template <int ROUNDS, bool ENCRYPT>
+__m128i GCM_crypt(const unsigned char* in, unsigned char* out, unsigned long length,
+                  const AES_GCM_KEY* key, __m128i ctr, __m128i y)
+{
+  const __m128i* const k = (const __m128i*)key->aes.rd_key;
+  const __m128i* const h = (const __m128i*)key->htable;
+  const __m128i* const hk = (const __m128i*)key->hkara;
+  const __m128i* src = (const __m128i*)in;
+  __m128i* dst = (__m128i*)out;
+  const __m128i* ghashSrc = NULL;
+  unsigned long blocks = length / 16;
+  while (blocks >= 8) {
+    __m128i d0 = _mm_xor_si128(CTR_byteswap(ctr), k[0]);
+    __m128i d1 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 1))), k[0]);
+    __m128i d2 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 2))), k[0]);
+    __m128i d3 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 3))), k[0]);
+    __m128i d4 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 4))), k[0]);
+    __m128i d5 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 5))), k[0]);
+    __m128i d6 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 6))), k[0]);
+    __m128i d7 = _mm_xor_si128(CTR_byteswap(_mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 7))), k[0]);
+    ctr = _mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 8));
+    if (!ENCRYPT)
+      ghashSrc = src;
+    if (ghashSrc != NULL) {
+      const __m128i* const g = ghashSrc;
+      __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[1]);
+      GHASH_mul_acc(_mm_xor_si128(y, CTR_byteswap(_mm_loadu_si128(g + 0))), h[7], hk[7], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[2]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 1)), h[6], hk[6], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[3]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 2)), h[5], hk[5], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[4]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 3)), h[4], hk[4], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[5]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 4)), h[3], hk[3], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[6]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 5)), h[2], hk[2], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[7]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 6)), h[1], hk[1], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[8]);
+      GHASH_mul_acc(CTR_byteswap(_mm_loadu_si128(g + 7)), h[0], hk[0], lo, mid, hi);
+      GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[9]);
+      y = GHASH_reduce(lo, mid, hi);
+      for (int r = 10; r < ROUNDS; ++r)
+        GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[r]);
+    }
+    else {
+      for (int r = 1; r < ROUNDS; ++r)
+        GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[r]);
+    }
+    const __m128i kl = k[ROUNDS];
+    _mm_storeu_si128(dst + 0, _mm_xor_si128(_mm_aesenclast_si128(d0, kl), _mm_loadu_si128(src + 0)));
+    _mm_storeu_si128(dst + 1, _mm_xor_si128(_mm_aesenclast_si128(d1, kl), _mm_loadu_si128(src + 1)));
+    _mm_storeu_si128(dst + 2, _mm_xor_si128(_mm_aesenclast_si128(d2, kl), _mm_loadu_si128(src + 2)));
+    _mm_storeu_si128(dst + 3, _mm_xor_si128(_mm_aesenclast_si128(d3, kl), _mm_loadu_si128(src + 3)));
+    _mm_storeu_si128(dst + 4, _mm_xor_si128(_mm_aesenclast_si128(d4, kl), _mm_loadu_si128(src + 4)));
+    _mm_storeu_si128(dst + 5, _mm_xor_si128(_mm_aesenclast_si128(d5, kl), _mm_loadu_si128(src + 5)));
+    _mm_storeu_si128(dst + 6, _mm_xor_si128(_mm_aesenclast_si128(d6, kl), _mm_loadu_si128(src + 6)));
+    _mm_storeu_si128(dst + 7, _mm_xor_si128(_mm_aesenclast_si128(d7, kl), _mm_loadu_si128(src + 7)));
+    if (ENCRYPT)
+      ghashSrc = dst;
+    src += 8;
+    dst += 8;
+    blocks -= 8;
+  }
+  // Chiffrat der letzten 8 Bloecke steht beim Verschluesseln noch aus
+  if (ENCRYPT && ghashSrc != NULL)
+    y = GHASH_blocks(y, (const unsigned char*)ghashSrc, 8, key);
+  // restliche Bloecke; beim Entschluesseln GHASH vorher, weil in == out sein darf
+  if (!ENCRYPT)
+    y = GHASH_update(y, (const unsigned char*)src, 16 * blocks + length % 16, key);
+  const unsigned char* tailStart = (const unsigned char*)dst;
+  while (blocks-- > 0) {
+    const __m128i ks = CTR_encrypt_block<ROUNDS>(CTR_byteswap(ctr), k);
+    _mm_storeu_si128(dst++, _mm_xor_si128(ks, _mm_loadu_si128(src++)));
+    ctr = _mm_add_epi32(ctr, _mm_set_epi32(0, 0, 0, 1));
+  }
+  if (length % 16 != 0) {
+    ALIGN16 unsigned char ks[16];
+    _mm_store_si128((__m128i*)ks, CTR_encrypt_block<ROUNDS>(CTR_byteswap(ctr), k));
+    const unsigned char* s = (const unsigned char*)src;
+    unsigned char* d = (unsigned char*)dst;
+    for (unsigned long i = 0; i < length % 16; ++i)
+      d[i] = s[i] ^ ks[i];
+  }
+  if (ENCRYPT)
+    y = GHASH_update(y, tailStart, out + length - tailStart, key);
+  return y;
+}
+
+// einzelnen Block mit key verschluesseln
+__m128i AES_encrypt_block(const AES_KEY_ALIGNED* key, __m128i block)
+{
+  const __m128i* const k = (const __m128i*)key->rd_key;
+  switch (key->rounds) {
+  case 10:
+    return CTR_encrypt_block<10>(block, k);
+  case 12:
+    return CTR_encrypt_block<12>(block, k);
+  default:
+    return CTR_encrypt_block<14>(block, k);
+  }
+}
+
+int AESNI_gcm_set_key(const unsigned char* userKey, const int bits, AES_GCM_KEY* key)
+{
+  const int status = AESNI_set_encrypt_key(userKey, bits, &key->aes);
+  if (status != 0)
+    return status;
+  // H = E(0), gespiegelt, und seine Potenzen bis H^8
+  __m128i* const htable = (__m128i*)key->htable;
+  __m128i* const hkara = (__m128i*)key->hkara;
+  htable[0] = CTR_byteswap(AES_encrypt_block(&key->aes, _mm_setzero_si128()));
+  for (int i = 1; i < 8; ++i)
+    htable[i] = GHASH_mul(htable[i - 1], htable[0]);
+  for (int i = 0; i < 8; ++i)
+    hkara[i] = GHASH_karatsuba_key(htable[i]);
+  return 0;
+}
+
+// gemeinsamer Teil von AESNI_gcm_seal() und AESNI_gcm_open(): liefert das Tag
+template <bool ENCRYPT>
+void GCM_seal_open(const AES_GCM_KEY* key, const unsigned char* iv, unsigned long ivlen,
+                   const unsigned char* aad, unsigned long aadlen,
+                   const unsigned char* in, unsigned char* out, unsigned long length,
+                   unsigned char tag[16])
+{
+  assert(key->aes.rounds == 10 || key->aes.rounds == 12 || key->aes.rounds == 14);
+  // J0 gespiegelt: der Zaehler steht dann in den unteren 32 Bit
+  __m128i j0;
+  if (ivlen == 12) {
+    ALIGN16 unsigned char block[16] = { 0 };
+    memcpy(block, iv, 12);
+    block[15] = 1;
+    j0 = CTR_byteswap(_mm_load_si128((const __m128i*)block));
+  }
+  else {
+    const uint64_t ivbits = (uint64_t)ivlen * 8;
+    j0 = GHASH_update(_mm_setzero_si128(), iv, ivlen, key);
+    j0 = GHASH_mul(_mm_xor_si128(j0, _mm_set_epi32(0, 0, (int)(ivbits >> 32), (int)ivbits)), ((const __m128i*)key->htable)[0]);
+  }
+  __m128i y = GHASH_update(_mm_setzero_si128(), aad, aadlen, key);
+  const __m128i ctr = _mm_add_epi32(j0, _mm_set_epi32(0, 0, 0, 1));
+  switch (key->aes.rounds) {
+  case 10:
+    y = GCM_crypt<10, ENCRYPT>(in, out, length, key, ctr, y);
+    break;
+  case 12:
+    y = GCM_crypt<12, ENCRYPT>(in, out, length, key, ctr, y);
+    break;
+  default:
+    y = GCM_crypt<14, ENCRYPT>(in, out, length, key, ctr, y);
+    break;
+  }
+  const uint64_t aadbits = (uint64_t)aadlen * 8;
+  const uint64_t bits = (uint64_t)length * 8;
+  const __m128i lengths = _mm_set_epi32((int)(aadbits >> 32), (int)aadbits, (int)(bits >> 32), (int)bits);
+  y = GHASH_mul(_mm_xor_si128(y, lengths), ((const __m128i*)key->htable)[0]);
+  _mm_storeu_si128((__m128i*)tag, _mm_xor_si128(CTR_byteswap(y), AES_encrypt_block(&key->aes, CTR_byteswap(j0))));
+}
+
+void AESNI_gcm_seal(const AES_GCM_KEY* key, const unsigned char* iv, unsigned long ivlen,
+                    const unsigned char* aad, unsigned long aadlen,
+                    const unsigned char* in, unsigned char* out, unsigned long length,
+                    unsigned char tag[16])
+{
+  GCM_seal_open<true>(key, iv, ivlen, aad, aadlen, in, out, length, tag);
+}
+
+int AESNI_gcm_open(const AES_GCM_KEY* key, const unsigned char* iv, unsigned long ivlen,
+                   const unsigned char* aad, unsigned long aadlen,
+                   const unsigned char* in, unsigned char* out, unsigned long length,
+                   const unsigned char tag[16])
+{
+  unsigned char computed[16];
+  GCM_seal_open<false>(key, iv, ivlen, aad, aadlen, in, out, length, computed);
+  // Vergleich in konstanter Zeit
+  unsigned char diff = 0;
+  for (int i = 0; i < 16; ++i)
+    diff |= computed[i] ^ tag[i];
+  if (diff != 0) {
+    // unechten Klartext nicht herausgeben
+    memset(out, 0, length);
+    return -1;
+  }
+  return 0;
+}
+
+
+// XTS: C = E1(P ^ T) ^ T mit T = E2(Sektornummer) * alpha^j fuer Block j
+
+// T * alpha in GF(2^128) (Little Endian): alle 32-Bit-Worte um 1 nach links
+// schieben; die herausfallenden Bits rotiert PSHUFD ins jeweils naechste
+// Wort, das oberste Bit wird zu x^7 + x^2 + x + 1 (0x87)
+inline __m128i XTS_double(__m128i t)
+{
+  const __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), _MM_SHUFFLE(2, 1, 0, 3));
+  return _mm_xor_si128(_mm_slli_epi32(t, 1), _mm_and_si128(carry, _mm_set_epi32(1, 1, 1, 0x87)));
+}
+
+template <int ROUNDS, bool ENCRYPT>
+inline __m128i XTS_block(__m128i data, __m128i t, const __m128i* k)
+{
+  data = _mm_xor_si128(_mm_xor_si128(data, t), k[0]);
+  for (int r = 1; r < ROUNDS; ++r)
+    data = ENCRYPT? _mm_aesenc_si128(data, k[r]) : _mm_aesdec_si128(data, k[r]);
+  data = ENCRYPT? _mm_aesenclast_si128(data, k[ROUNDS]) : _mm_aesdeclast_si128(data, k[ROUNDS]);
+  return _mm_xor_si128(data, t);
+}
+
+// length Bytes (mindestens 16) mit dem verschluesselten Tweak t ver- bzw.
+// entschluesseln, 8 Bloecke parallel. Ist length kein Vielfaches von 16,
+// stiehlt der letzte, unvollstaendige Block den Rest des vorletzten.
+template <int ROUNDS, bool ENCRYPT>
+void XTS_crypt(const unsigned char* in, unsigned char* out, unsigned long length, const __m128i* k, __m128i t)
+{
+  assert(length >= 16);
+  const __m128i* src = (const __m128i*)in;
+  __m128i* dst = (__m128i*)out;
+  const unsigned long tail = length % 16;
+  unsigned long blocks = length / 16;
+  if (tail != 0)
+    --blocks;
+  while (blocks >= 8) {
+    const __m128i t0 = t;
+    const __m128i t1 = XTS_double(t0);
+    const __m128i t2 = XTS_double(t1);
+    const __m128i t3 = XTS_double(t2);
+    const __m128i t4 = XTS_double(t3);
+    const __m128i t5 = XTS_double(t4);
+    const __m128i t6 = XTS_double(t5);
+    const __m128i t7 = XTS_double(t6);
+    t = XTS_double(t7);
+    __m128i d0 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 0), t0), k[0]);
+    __m128i d1 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 1), t1), k[0]);
+    __m128i d2 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 2), t2), k[0]);
+    __m128i d3 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 3), t3), k[0]);
+    __m128i d4 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 4), t4), k[0]);
+    __m128i d5 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 5), t5), k[0]);
+    __m128i d6 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 6), t6), k[0]);
+    __m128i d7 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(src + 7), t7), k[0]);
+    for (int r = 1; r < ROUNDS; ++r) {
+      const __m128i kr = k[r];
+      if (ENCRYPT) {
+        d0 = _mm_aesenc_si128(d0, kr);
+        d1 = _mm_aesenc_si128(d1, kr);
+        d2 = _mm_aesenc_si128(d2, kr);
+        d3 = _mm_aesenc_si128(d3, kr);
+        d4 = _mm_aesenc_si128(d4, kr);
+        d5 = _mm_aesenc_si128(d5, kr);
+        d6 = _mm_aesenc_si128(d6, kr);
+        d7 = _mm_aesenc_si128(d7, kr);
+      }
+      else {
+        d0 = _mm_aesdec_si128(d0, kr);
+        d1 = _mm_aesdec_si128(d1, kr);
+        d2 = _mm_aesdec_si128(d2, kr);
+        d3 = _mm_aesdec_si128(d3, kr);
+        d4 = _mm_aesdec_si128(d4, kr);
+        d5 = _mm_aesdec_si128(d5, kr);
+        d6 = _mm_aesdec_si128(d6, kr);
+        d7 = _mm_aesdec_si128(d7, kr);
+      }
+    }
+    const __m128i kl = k[ROUNDS];
+    if (ENCRYPT) {
+      d0 = _mm_aesenclast_si128(d0, kl);
+      d1 = _mm_aesenclast_si128(d1, kl);
+      d2 = _mm_aesenclast_si128(d2, kl);
+      d3 = _mm_aesenclast_si128(d3, kl);
+      d4 = _mm_aesenclast_si128(d4, kl);
+      d5 = _mm_aesenclast_si128(d5, kl);
+      d6 = _mm_aesenclast_si128(d6, kl);
+      d7 = _mm_aesenclast_si128(d7, kl);
+    }
+    else {
+      d0 = _mm_aesdeclast_si128(d0, kl);
+      d1 = _mm_aesdeclast_si128(d1, kl);
+      d2 = _mm_aesdeclast_si128(d2, kl);
+      d3 = _mm_aesdeclast_si128(d3, kl);
+      d4 = _mm_aesdeclast_si128(d4, kl);
+      d5 = _mm_aesdeclast_si128(d5, kl);
+      d6 = _mm_aesdeclast_si128(d6, kl);
+      d7 = _mm_aesdeclast_si128(d7, kl);
+    }
+    _mm_storeu_si128(dst + 0, _mm_xor_si128(d0, t0));
+    _mm_storeu_si128(dst + 1, _mm_xor_si128(d1, t1));
+    _mm_storeu_si128(dst + 2, _mm_xor_si128(d2, t2));
+    _mm_storeu_si128(dst + 3, _mm_xor_si128(d3, t3));
+    _mm_storeu_si128(dst + 4, _mm_xor_si128(d4, t4));
+    _mm_storeu_si128(dst + 5, _mm_xor_si128(d5, t5));
+    _mm_storeu_si128(dst + 6, _mm_xor_si128(d6, t6));
+    _mm_storeu_si128(dst + 7, _mm_xor_si128(d7, t7));
+    src += 8;
+    dst += 8;
+    blocks -= 8;
+  }
+  while (blocks-- > 0) {
+    _mm_storeu_si128(dst++, XTS_block<ROUNDS, ENCRYPT>(_mm_loadu_si128(src++), t, k));
+    t = XTS_double(t);
+  }
+  if (tail != 0) {
+    // Verschluesseln: vorletzter Block mit T(m-1), letzter mit T(m);
+    // Entschluesseln in umgekehrter Reihenfolge
+    const __m128i tNext = XTS_double(t);
+    ALIGN16 unsigned char buf[16];
+    _mm_store_si128((__m128i*)buf, XTS_block<ROUNDS, ENCRYPT>(_mm_loadu_si128(src), ENCRYPT? t : tNext, k));
+    const unsigned char* last = (const unsigned char*)(src + 1);
+    unsigned char* lastOut = (unsigned char*)(dst + 1);
+    for (unsigned long i = 0; i < tail; ++i) {
+      const unsigned char c = buf[i];
+      buf[i] = last[i];
+      lastOut[i] = c;
+    }
+    _mm_storeu_si128(dst, XTS_block<ROUNDS, ENCRYPT>(_mm_load_si128((const __m128i*)buf), ENCRYPT? tNext : t, k));
+  }
+}
+
+// Tweaks fuer die Sektoren sector ... sector+7 gleichzeitig berechnen
+template <int ROUNDS>
+inline void XTS_tweaks_8(uint64_t sector, const __m128i* k, __m128i* t)
+{
+  const __m128i s = _mm_set_epi32(0, 0, (int)(sector >> 32), (int)sector);
+  __m128i d0 = _mm_xor_si128(s, k[0]);
+  __m128i d1 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 1)), k[0]);
+  __m128i d2 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 2)), k[0]);
+  __m128i d3 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 3)), k[0]);
+  __m128i d4 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 4)), k[0]);
+  __m128i d5 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 5)), k[0]);
+  __m128i d6 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 6)), k[0]);
+  __m128i d7 = _mm_xor_si128(_mm_add_epi64(s, _mm_set_epi32(0, 0, 0, 7)), k[0]);
+  for (int r = 1; r < ROUNDS; ++r)
+    GCM_round_8(d0, d1, d2, d3, d4, d5, d6, d7, k[r]);
+  t[0] = _mm_aesenclast_si128(d0, k[ROUNDS]);
+  t[1] = _mm_aesenclast_si128(d1, k[ROUNDS]);
+  t[2] = _mm_aesenclast_si128(d2, k[ROUNDS]);
+  t[3] = _mm_aesenclast_si128(d3, k[ROUNDS]);
+  t[4] = _mm_aesenclast_si128(d4, k[ROUNDS]);
+  t[5] = _mm_aesenclast_si128(d5, k[ROUNDS]);
+  t[6] = _mm_aesenclast_si128(d6, k[ROUNDS]);
+  t[7] = _mm_aesenclast_si128(d7, k[ROUNDS]);
+}
+
+template <int ROUNDS, bool ENCRYPT>
+void XTS_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize,
+                 unsigned long numSectors, uint64_t sector, const __m128i* k1, const __m128i* k2)
+{
+  __m128i t[8];
+  while (numSectors > 0) {
+    XTS_tweaks_8<ROUNDS>(sector, k2, t);
+    const unsigned long n = (numSectors < 8)? numSectors : 8;
+    for (unsigned long i = 0; i < n; ++i) {
+      XTS_crypt<ROUNDS, ENCRYPT>(in, out, sectorSize, k1, t[i]);
+      in += sectorSize;
+      out += sectorSize;
+    }
+    sector += n;
+    numSectors -= n;
+  }
+}
+
+template <bool ENCRYPT>
+void XTS_crypt(const unsigned char* in, unsigned char* out, unsigned long length,
+               AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, const unsigned char iv[16])
+{
+  assert(key1->rounds == 10 || key1->rounds == 12 || key1->rounds == 14);
+  const __m128i* const k1 = (__m128i*)key1->rd_key;
+  const __m128i t = AES_encrypt_block(key2, _mm_loadu_si128((const __m128i*)iv));
+  switch (key1->rounds) {
+  case 10:
+    XTS_crypt<10, ENCRYPT>(in, out, length, k1, t);
+    break;
+  case 12:
+    XTS_crypt<12, ENCRYPT>(in, out, length, k1, t);
+    break;
+  case 14:
+    XTS_crypt<14, ENCRYPT>(in, out, length, k1, t);
+    break;
+  }
+}
+
+template <bool ENCRYPT>
+void XTS_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize,
+                 unsigned long numSectors, uint64_t firstSector,
+                 AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2)
+{
+  assert(key1->rounds == 10 || key1->rounds == 12 || key1->rounds == 14);
+  assert(key1->rounds == key2->rounds);
+  const __m128i* const k1 = (__m128i*)key1->rd_key;
+  const __m128i* const k2 = (__m128i*)key2->rd_key;
+  switch (key1->rounds) {
+  case 10:
+    XTS_sectors<10, ENCRYPT>(in, out, sectorSize, numSectors, firstSector, k1, k2);
+    break;
+  case 12:
+    XTS_sectors<12, ENCRYPT>(in, out, sectorSize, numSectors, firstSector, k1, k2);
+    break;
+  case 14:
+    XTS_sectors<14, ENCRYPT>(in, out, sectorSize, numSectors, firstSector, k1, k2);
+    break;
+  }
+}
+
+void AESNI_xts_encrypt(const unsigned char* in, unsigned char* out, unsigned long length,
+                       AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, const unsigned char iv[16])
+{
+  XTS_crypt<true>(in, out, length, key1, key2, iv);
+}
+
+void AESNI_xts_decrypt(const unsigned char* in, unsigned char* out, unsigned long length,
+                       AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, const unsigned char iv[16])
+{
+  XTS_crypt<false>(in, out, length, key1, key2, iv);
+}
+
+void AESNI_xts_encrypt_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize,
+                               unsigned long numSectors, uint64_t firstSector,
+                               AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2)
+{
+  XTS_sectors<true>(in, out, sectorSize, numSectors, firstSector, key1, key2);
+}
+
+void AESNI_xts_decrypt_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize,
+                               unsigned long numSectors, uint64_t firstSector,
+                               AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2)
+{
+  XTS_sectors<false>(in, out, sectorSize, numSectors, firstSector, key1, key2);
+}
+
+
+// Multi-Buffer-CBC: CBC-Verschluesselung ist je Strom seriell, also
+// verschluesselt CBC_encrypt_mb_8() je einen Block aus 8 unabhaengigen
+// Stroemen gleichzeitig. Der Scheduler (nach dem Vorbild von Intels
+// Multi-Buffer-Manager) belegt die 8 Bahnen mit Jobs, laesst alle so
+// viele Bloecke laufen, wie der kuerzeste noch hat, und besetzt frei
+// gewordene Bahnen mit dem naechsten Job. Leere Bahnen verschluesseln
+// einen Dummy-Block auf der Stelle (step = 0). Sind keine Jobs mehr
+// uebrig und hoechstens CBC_MB_SERIAL_LANES Bahnen belegt, lohnt das
+// nicht mehr: Wie der Flush in Intels Multi-Buffer-Manager verschluesselt
+// dann AESNI_cbc_encrypt() die restlichen Bloecke Strom fuer Strom.
+// Bei 8 Bloecken pro Runde ist der Durchsatz der AES-Einheit ausgeschoepft,
+// ein einzelner Strom dagegen durch die Latenz von etwa 4 Takten pro
+// Runde begrenzt; 2 serielle Stroeme kosten also so viel wie 8 Bahnen.
+static const int CBC_MB_SERIAL_LANES = 2;
+
+struct CBC_MB_LANE {
+  __m128i feedback;
+  const __m128i* in;
+  __m128i* out;
+  const __m128i* k;
+  int step;
+  unsigned long blocks;
+  AESNI_CBC_JOB* job;
+};
+
+template <int ROUNDS>
+void CBC_encrypt_mb_8(CBC_MB_LANE* lane, unsigned long blocks)
+{
+  const __m128i* in0 = lane[0].in;
+  const __m128i* in1 = lane[1].in;
+  const __m128i* in2 = lane[2].in;
+  const __m128i* in3 = lane[3].in;
+  const __m128i* in4 = lane[4].in;
+  const __m128i* in5 = lane[5].in;
+  const __m128i* in6 = lane[6].in;
+  const __m128i* in7 = lane[7].in;
+  __m128i* out0 = lane[0].out;
+  __m128i* out1 = lane[1].out;
+  __m128i* out2 = lane[2].out;
+  __m128i* out3 = lane[3].out;
+  __m128i* out4 = lane[4].out;
+  __m128i* out5 = lane[5].out;
+  __m128i* out6 = lane[6].out;
+  __m128i* out7 = lane[7].out;
+  const __m128i* const k0 = lane[0].k;
+  const __m128i* const k1 = lane[1].k;
+  const __m128i* const k2 = lane[2].k;
+  const __m128i* const k3 = lane[3].k;
+  const __m128i* const k4 = lane[4].k;
+  const __m128i* const k5 = lane[5].k;
+  const __m128i* const k6 = lane[6].k;
+  const __m128i* const k7 = lane[7].k;
+  const int s0 = lane[0].step;
+  const int s1 = lane[1].step;
+  const int s2 = lane[2].step;
+  const int s3 = lane[3].step;
+  const int s4 = lane[4].step;
+  const int s5 = lane[5].step;
+  const int s6 = lane[6].step;
+  const int s7 = lane[7].step;
+  __m128i f0 = lane[0].feedback;
+  __m128i f1 = lane[1].feedback;
+  __m128i f2 = lane[2].feedback;
+  __m128i f3 = lane[3].feedback;
+  __m128i f4 = lane[4].feedback;
+  __m128i f5 = lane[5].feedback;
+  __m128i f6 = lane[6].feedback;
+  __m128i f7 = lane[7].feedback;
+  for (unsigned long i = 0; i < blocks; ++i) {
+    f0 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in0), f0), k0[0]);
+    f1 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in1), f1), k1[0]);
+    f2 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in2), f2), k2[0]);
+    f3 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in3), f3), k3[0]);
+    f4 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in4), f4), k4[0]);
+    f5 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in5), f5), k5[0]);
+    f6 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in6), f6), k6[0]);
+    f7 = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128(in7), f7), k7[0]);
+    for (int r = 1; r < ROUNDS; ++r) {
+      f0 = _mm_aesenc_si128(f0, k0[r]);
+      f1 = _mm_aesenc_si128(f1, k1[r]);
+      f2 = _mm_aesenc_si128(f2, k2[r]);
+      f3 = _mm_aesenc_si128(f3, k3[r]);
+      f4 = _mm_aesenc_si128(f4, k4[r]);
+      f5 = _mm_aesenc_si128(f5, k5[r]);
+      f6 = _mm_aesenc_si128(f6, k6[r]);
+      f7 = _mm_aesenc_si128(f7, k7[r]);
+    }
+    f0 = _mm_aesenclast_si128(f0, k0[ROUNDS]);
+    f1 = _mm_aesenclast_si128(f1, k1[ROUNDS]);
+    f2 = _mm_aesenclast_si128(f2, k2[ROUNDS]);
+    f3 = _mm_aesenclast_si128(f3, k3[ROUNDS]);
+    f4 = _mm_aesenclast_si128(f4, k4[ROUNDS]);
+    f5 = _mm_aesenclast_si128(f5, k5[ROUNDS]);
+    f6 = _mm_aesenclast_si128(f6, k6[ROUNDS]);
+    f7 = _mm_aesenclast_si128(f7, k7[ROUNDS]);
+    _mm_storeu_si128(out0, f0);
+    _mm_storeu_si128(out1, f1);
+    _mm_storeu_si128(out2, f2);
+    _mm_storeu_si128(out3, f3);
+    _mm_storeu_si128(out4, f4);
+    _mm_storeu_si128(out5, f5);
+    _mm_storeu_si128(out6, f6);
+    _mm_storeu_si128(out7, f7);
+    in0 += s0; out0 += s0;
+    in1 += s1; out1 += s1;
+    in2 += s2; out2 += s2;
+    in3 += s3; out3 += s3;
+    in4 += s4; out4 += s4;
+    in5 += s5; out5 += s5;
+    in6 += s6; out6 += s6;
+    in7 += s7; out7 += s7;
+  }
+  lane[0].in = in0; lane[0].out = out0; lane[0].feedback = f0;
+  lane[1].in = in1; lane[1].out = out1; lane[1].feedback = f1;
+  lane[2].in = in2; lane[2].out = out2; lane[2].feedback = f2;
+  lane[3].in = in3; lane[3].out = out3; lane[3].feedback = f3;
+  lane[4].in = in4; lane[4].out = out4; lane[4].feedback = f4;
+  lane[5].in = in5; lane[5].out = out5; lane[5].feedback = f5;
+  lane[6].in = in6; lane[6].out = out6; lane[6].feedback = f6;
+  lane[7].in = in7; lane[7].out = out7; lane[7].feedback = f7;
+}
+
+// Jobs mit gleicher Rundenzahl, absteigend nach Laenge sortiert: Die
+// langen Jobs laufen zuerst, die kurzen fuellen am Ende die Luecken.
+template <int ROUNDS>
+void CBC_encrypt_mb(AESNI_CBC_JOB** queue, unsigned long numJobs)
+{
+  static const int LANES = 8;
+  ALIGN16 __m128i dummy[2];
+  dummy[0] = _mm_setzero_si128();
+  CBC_MB_LANE lane[LANES];
+  for (int i = 0; i < LANES; ++i) {
+    lane[i].feedback = _mm_setzero_si128();
+    lane[i].in = &dummy[0];
+    lane[i].out = &dummy[1];
+    lane[i].k = (const __m128i*)queue[0]->key->rd_key;
+    lane[i].step = 0;
+    lane[i].blocks = 0;
+    lane[i].job = NULL;
+  }
+  unsigned long next = 0;
+  int active = 0;
+  for (;;) {
+    // freie Bahnen belegen
+    for (int i = 0; i < LANES; ++i) {
+      if (lane[i].job != NULL || next == numJobs)
+        continue;
+      AESNI_CBC_JOB* job = queue[next++];
+      if (job->length < 16) {
+        // leerer Job: Bahn im naechsten Durchlauf erneut versuchen
+        --i;
+        continue;
+      }
+      lane[i].feedback = _mm_loadu_si128((const __m128i*)job->ivec);
+      lane[i].in = (const __m128i*)job->in;
+      lane[i].out = (__m128i*)job->out;
+      lane[i].k = (const __m128i*)job->key->rd_key;
+      lane[i].step = 1;
+      lane[i].blocks = job->length / 16;
+      lane[i].job = job;
+      ++active;
+    }
+    if (active == 0)
+      break;
+    if (next == numJobs && active <= CBC_MB_SERIAL_LANES) {
+      for (int i = 0; i < LANES; ++i) {
+        AESNI_CBC_JOB* job = lane[i].job;
+        if (job == NULL)
+          continue;
+        _mm_storeu_si128((__m128i*)job->ivec, lane[i].feedback);
+        AESNI_cbc_encrypt((const unsigned char*)lane[i].in, (unsigned char*)lane[i].out,
+                          job->ivec, 16 * lane[i].blocks, job->key);
+        // AESNI_cbc_encrypt() schreibt ivec nicht fort
+        memcpy(job->ivec, (const unsigned char*)lane[i].out + 16 * (lane[i].blocks - 1), 16);
+      }
+      break;
+    }
+    unsigned long blocks = ~0UL;
+    for (int i = 0; i < LANES; ++i)
+      if (lane[i].job != NULL && lane[i].blocks < blocks)
+        blocks = lane[i].blocks;
+    CBC_encrypt_mb_8<ROUNDS>(lane, blocks);
+    // fertige Jobs austragen, ihre Bahnen laufen als Dummy weiter
+    for (int i = 0; i < LANES; ++i) {
+      if (lane[i].job == NULL)
+        continue;
+      lane[i].blocks -= blocks;
+      if (lane[i].blocks == 0) {
+        _mm_storeu_si128((__m128i*)lane[i].job->ivec, lane[i].feedback);
+        lane[i].in = &dummy[0];
+        lane[i].out = &dummy[1];
+        lane[i].step = 0;
+        lane[i].job = NULL;
+        --active;
+      }
+    }
+  }
+}
+
+bool CBC_job_before(const AESNI_CBC_JOB* a, const AESNI_CBC_JOB* b)
+{
+  if (a->key->rounds != b->key->rounds)
+    return a->key->rounds < b->key->rounds;
+  return a->length > b->length;
+}
+
+void AESNI_cbc_encrypt_mb(AESNI_CBC_JOB* jobs, unsigned long numJobs)
+{
+  if (numJobs == 0)
+    return;
+  // nach Rundenzahl gruppieren, innerhalb der Gruppen die laengsten zuerst
+  AESNI_CBC_JOB** queue = new AESNI_CBC_JOB*[numJobs];
+  for (unsigned long i = 0; i < numJobs; ++i) {
+    assert(jobs[i].key->rounds == 10 || jobs[i].key->rounds == 12 || jobs[i].key->rounds == 14);
+    assert(jobs[i].length % 16 == 0);
+    queue[i] = &jobs[i];
+  }
+  std::sort(queue, queue + numJobs, CBC_job_before);
+  unsigned long first = 0;
+  while (first < numJobs) {
+    const unsigned int rounds = queue[first]->key->rounds;
+    unsigned long last = first + 1;
+    while (last < numJobs && queue[last]->key->rounds == rounds)
+      ++last;
+    switch (rounds) {
+    case 10:
+      CBC_encrypt_mb<10>(queue + first, last - first);
+      break;
+    case 12:
+      CBC_encrypt_mb<12>(queue + first, last - first);
+      break;
+    case 14:
+      CBC_encrypt_mb<14>(queue + first, last - first);
+      break;
+    }
+    first = last;
+  }
+  delete [] queue;
+}
@@ -31,12 +31,62 @@ struct AES_KEY_ALIGNED {
   ALIGN16 unsigned int rounds;
 };
 
+// Schluessel fuer AES-GCM: Rundenschluessel plus H^1 ... H^8 fuer GHASH
+struct AES_GCM_KEY {
+  AES_KEY_ALIGNED aes;
+  ALIGN16 unsigned char htable[8 * 16];
+  ALIGN16 unsigned char hkara[8 * 16];
+};
+
+// ein Strom fuer AESNI_cbc_encrypt_mb()
+struct AESNI_CBC_JOB {
+  const unsigned char* in;
+  unsigned char* out;
+  unsigned long length; // Vielfaches von 16
+  AES_KEY_ALIGNED* key; // von AESNI_set_encrypt_key()
+  unsigned char ivec[16]; // danach: letzter Chiffratblock zum Fortsetzen
+};
+
 #include <openssl/aes.h>
 
 // Intrinsics
 int AESNI_set_encrypt_key(const unsigned char* userKey, const int bits, AES_KEY_ALIGNED* key);
 int AESNI_set_decrypt_key(const unsigned char* userKey, const int bits, AES_KEY_ALIGNED* key);
 void AESNI_cbc_encrypt(const unsigned char* in, unsigned char* out, unsigned char ivec[16], unsigned long length, AES_KEY_ALIGNED* key);
+// 8 Bloecke parallel
 void AESNI_cbc_decrypt(const unsigned char* in, unsigned char* out, unsigned char ivec[16], unsigned long length, AES_KEY_ALIGNED* key);
+// 4 Bloecke parallel
+void AESNI_cbc_decrypt4(const unsigned char* in, unsigned char* out, unsigned char ivec[16], unsigned long length, AES_KEY_ALIGNED* key);
+// ein Block nach dem anderen
+void AESNI_cbc_decrypt_serial(const unsigned char* in, unsigned char* out, unsigned char ivec[16], unsigned long length, AES_KEY_ALIGNED* key);
+// CTR-Modus mit 8 Bloecken parallel, Semantik wie AES_ctr128_encrypt() von
+// OpenSSL: ivec ist der 128-Bit-Zaehler (Big Endian), ecount_buf und num
+// merken sich den angebrochenen Schluesselstromblock fuer den naechsten Aufruf
+// (vor dem ersten Aufruf: *num = 0). Ver- und Entschluesseln sind identisch.
+void AESNI_ctr_crypt(const unsigned char* in, unsigned char* out, unsigned long length, AES_KEY_ALIGNED* key, unsigned char ivec[16], unsigned char ecount_buf[16], unsigned int* num);
+// ivec, ecount_buf und num fuer AESNI_ctr_crypt() so setzen, dass es beim
+// Byte offset des mit dem Startzaehler iv erzeugten Schluesselstroms beginnt
+void AESNI_ctr_seek(const unsigned char iv[16], uint64_t offset, AES_KEY_ALIGNED* key, unsigned char ivec[16], unsigned char ecount_buf[16], unsigned int* num);
+// AES-GCM (benoetigt PCLMULQDQ): AESNI_gcm_seal() verschluesselt und
+// liefert das 16 Byte lange Tag ueber aad und Chiffrat, AESNI_gcm_open()
+// entschluesselt und prueft das Tag. Stimmt es nicht, liefert sie -1 und
+// loescht out, sonst 0. in und out duerfen gleich sein; ivlen ist
+// ueblicherweise 12.
+int AESNI_gcm_set_key(const unsigned char* userKey, const int bits, AES_GCM_KEY* key);
+void AESNI_gcm_seal(const AES_GCM_KEY* key, const unsigned char* iv, unsigned long ivlen, const unsigned char* aad, unsigned long aadlen, const unsigned char* in, unsigned char* out, unsigned long length, unsigned char tag[16]);
+int AESNI_gcm_open(const AES_GCM_KEY* key, const unsigned char* iv, unsigned long ivlen, const unsigned char* aad, unsigned long aadlen, const unsigned char* in, unsigned char* out, unsigned long length, const unsigned char tag[16]);
+// AES-XTS mit 8 Bloecken parallel: key1 ist der Datenschluessel
+// (AESNI_set_encrypt_key() bzw. AESNI_set_decrypt_key()), key2 der
+// Tweak-Schluessel (immer AESNI_set_encrypt_key()). length muss mindestens
+// 16 sein; ist es kein Vielfaches von 16, greift Ciphertext Stealing.
+void AESNI_xts_encrypt(const unsigned char* in, unsigned char* out, unsigned long length, AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, const unsigned char iv[16]);
+void AESNI_xts_decrypt(const unsigned char* in, unsigned char* out, unsigned long length, AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2, const unsigned char iv[16]);
+// numSectors aufeinanderfolgende Sektoren zu je sectorSize Bytes ab Sektor
+// firstSector; der Tweak ist die Sektornummer (128 Bit, Little Endian)
+void AESNI_xts_encrypt_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize, unsigned long numSectors, uint64_t firstSector, AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2);
+void AESNI_xts_decrypt_sectors(const unsigned char* in, unsigned char* out, unsigned long sectorSize, unsigned long numSectors, uint64_t firstSector, AES_KEY_ALIGNED* key1, AES_KEY_ALIGNED* key2);
+// Multi-Buffer-CBC: numJobs unabhaengige Stroeme verschluesseln, je 8
+// gleichzeitig; Schluessel und Laengen duerfen sich unterscheiden
+void AESNI_cbc_encrypt_mb(AESNI_CBC_JOB* jobs, unsigned long numJobs);
 
 #endif // __AESNI_H_
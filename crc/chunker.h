@@ -0,0 +1,231 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __CHUNKER_H_
+#define __CHUNKER_H_
+
+#if defined(WIN32)
+#include <Windows.h>
+#elif defined(__GNUC__)
+#include <pthread.h>
+#endif
+
+#if defined(WIN32)
+#include "gnutypes.h"
+#elif defined(__GNUC__)
+#include <stdint.h>
+#endif
+
+#include <stddef.h>
+#include <vector>
+
+
+// Zerlegt einen Speicherblock in Abschnitte (Chunks), deren Grenzen vom
+// Inhalt abhaengen (content-defined chunking), etwa fuer die Deduplizierung
+// von Backups.
+//
+// Ueber jedes Fenster von windowBytes() Bytes wird ein rollender CRC
+// gebildet. Eine Position p ist eine moegliche Schnittstelle, wenn der
+// CRC des Fensters, das bei p endet, in allen Bits von mask() gesetzt ist.
+// Weil ein eingefuegtes oder geloeschtes Byte nur die Fenster in seiner
+// Naehe veraendert, verschieben sich alle weiter entfernten Grenzen mit
+// den Daten, statt sich zu veraendern.
+//
+// Ein Chunk ist mindestens minSize() und hoechstens maxSize() Bytes lang
+// (bis auf den letzten). Er endet an der ersten moeglichen Schnittstelle
+// hinter minSize(), sonst nach maxSize() Bytes. Fuer jeden Chunk wird
+// zusaetzlich der CRC ueber seinen gesamten Inhalt berechnet.
+//
+// Die Suche nach Schnittstellen haengt nur vom Inhalt ab, nicht von der
+// Lage der Chunks. Sie laesst sich deshalb auf mehrere Threads verteilen;
+// die anschliessende Auswahl der Grenzen geschieht seriell und liefert
+// unabhaengig von der Anzahl der Threads dasselbe Ergebnis.
+//
+// ROLLINGCRC ist RollingCrc<> oder RollingCrc32cSSE4 aus crcutil-fast,
+// CRCIMPL eine Klasse aus crcutil-fast, die CrcDefault() anbietet.
+template <class ROLLINGCRC, class CRCIMPL>
+class Chunker {
+public:
+  typedef typename CRCIMPL::Crc Crc;
+
+  struct Chunk {
+    uint64_t offset;
+    size_t size;
+    Crc crc;
+  };
+
+  static const size_t DEFAULT_MIN_SIZE = 2 * 1024;
+  static const size_t DEFAULT_MAX_SIZE = 64 * 1024;
+  // 13 Bit => durchschnittlich alle 8 KByte eine moegliche Schnittstelle
+  static const size_t DEFAULT_MASK = (1 << 13) - 1;
+
+  Chunker(const ROLLINGCRC& rollingCrc, const CRCIMPL& crcImpl, int numThreads,
+    size_t minSize = DEFAULT_MIN_SIZE, size_t maxSize = DEFAULT_MAX_SIZE, size_t mask = DEFAULT_MASK)
+    : mRollingCrc(rollingCrc)
+    , mCrcImpl(crcImpl)
+    , mNumThreads((numThreads > 0)? numThreads : 1)
+    , mMinSize((minSize > rollingCrc.WindowBytes())? minSize : rollingCrc.WindowBytes())
+    , mMaxSize((maxSize > mMinSize)? maxSize : mMinSize)
+    , mMask((Crc)mask)
+  { /* ... */ }
+
+  inline size_t windowBytes(void) const { return mRollingCrc.WindowBytes(); }
+  inline size_t minSize(void) const { return mMinSize; }
+  inline size_t maxSize(void) const { return mMaxSize; }
+  inline Crc mask(void) const { return mMask; }
+  inline int numThreads(void) const { return mNumThreads; }
+
+  // zerlegt den Block in Chunks und haengt sie an chunks an
+  void process(const void* data, size_t bytes, std::vector<Chunk>& chunks) const
+  {
+    const uint8_t* const buf = reinterpret_cast<const uint8_t*>(data);
+    const size_t window = windowBytes();
+
+    // 1. moegliche Schnittstellen parallel suchen
+    std::vector<size_t> candidates;
+    if (bytes > window) {
+      const size_t positions = bytes - window;
+      int numSlices = mNumThreads;
+      if (positions / numSlices < MIN_SLICE_SIZE)
+        numSlices = (int)(positions / MIN_SLICE_SIZE) + 1;
+      std::vector<Job> jobs(numSlices);
+      for (int i = 0; i < numSlices; ++i) {
+        jobs[i].self = this;
+        jobs[i].data = buf;
+        jobs[i].chunks = NULL;
+        jobs[i].first = window + i * (positions / numSlices);
+        jobs[i].last = (i == numSlices - 1)? bytes : window + (i + 1) * (positions / numSlices);
+      }
+      runJobs(jobs, ScanThreadProc);
+      for (int i = 0; i < numSlices; ++i)
+        candidates.insert(candidates.end(), jobs[i].candidates.begin(), jobs[i].candidates.end());
+    }
+
+    // 2. Grenzen unter Beachtung von Mindest- und Hoechstgroesse waehlen
+    const size_t firstChunk = chunks.size();
+    std::vector<size_t>::const_iterator c = candidates.begin();
+    for (size_t start = 0; start < bytes; ) {
+      size_t end;
+      if (bytes - start <= mMinSize) {
+        end = bytes;
+      }
+      else {
+        while (c != candidates.end() && *c < start + mMinSize)
+          ++c;
+        const size_t limit = (bytes - start < mMaxSize)? bytes : start + mMaxSize;
+        end = (c != candidates.end() && *c <= limit)? *c : limit;
+      }
+      Chunk chunk = { start, end - start, 0 };
+      chunks.push_back(chunk);
+      start = end;
+    }
+
+    // 3. CRCs der Chunks parallel berechnen
+    const size_t numChunks = chunks.size() - firstChunk;
+    if (numChunks == 0)
+      return;
+    const int numSlices = ((size_t)mNumThreads < numChunks)? mNumThreads : (int)numChunks;
+    std::vector<Job> jobs(numSlices);
+    for (int i = 0; i < numSlices; ++i) {
+      jobs[i].self = this;
+      jobs[i].data = buf;
+      jobs[i].chunks = &chunks[firstChunk];
+      jobs[i].first = i * numChunks / numSlices;
+      jobs[i].last = (i + 1) * numChunks / numSlices;
+    }
+    runJobs(jobs, CrcThreadProc);
+  }
+
+private:
+  // unterhalb dieser Groesse lohnt das Erzeugen von Threads nicht
+  static const size_t MIN_SLICE_SIZE = 256 * 1024;
+
+  struct Job {
+    const Chunker* self;
+    const uint8_t* data;
+    size_t first; // erste Position bzw. erster Chunk
+    size_t last;  // Position bzw. Chunk hinter dem letzten
+    std::vector<size_t> candidates;
+    Chunk* chunks;
+  };
+
+#if defined(WIN32)
+  typedef DWORD (WINAPI *JobProc)(LPVOID);
+#elif defined(__GNUC__)
+  typedef void* (*JobProc)(void*);
+#endif
+
+  // den ersten Job im aufrufenden Thread ausfuehren, alle anderen in eigenen Threads
+  static void runJobs(std::vector<Job>& jobs, JobProc proc)
+  {
+    const int numJobs = (int)jobs.size();
+#if defined(WIN32)
+    std::vector<HANDLE> hThread(numJobs);
+    for (int i = 1; i < numJobs; ++i)
+      hThread[i - 1] = CreateThread(NULL, 0, proc, (LPVOID)&jobs[i], 0, NULL);
+    proc((LPVOID)&jobs[0]);
+    if (numJobs > 1)
+      WaitForMultipleObjects(numJobs - 1, &hThread[0], TRUE, INFINITE);
+    for (int i = 0; i < numJobs - 1; ++i)
+      CloseHandle(hThread[i]);
+#elif defined(__GNUC__)
+    std::vector<pthread_t> hThread(numJobs);
+    for (int i = 1; i < numJobs; ++i)
+      pthread_create(&hThread[i - 1], NULL, proc, (void*)&jobs[i]);
+    proc((void*)&jobs[0]);
+    for (int i = 0; i < numJobs - 1; ++i)
+      pthread_join(hThread[i], NULL);
+#endif
+  }
+
+  // sammelt alle Positionen p in [first, last), an denen das Fenster
+  // [p - windowBytes(), p) eine Schnittstelle ergibt
+#if defined(WIN32)
+  static DWORD WINAPI
+#elif defined(__GNUC__)
+  static void*
+#endif
+  ScanThreadProc(void* lpParameter)
+  {
+    Job* job = reinterpret_cast<Job*>(lpParameter);
+    const ROLLINGCRC& rollingCrc = job->self->mRollingCrc;
+    const Crc mask = job->self->mMask;
+    const size_t window = rollingCrc.WindowBytes();
+    const uint8_t* const data = job->data;
+    Crc crc = rollingCrc.Start(data + job->first - window);
+    for (size_t p = job->first; ; ++p) {
+      if ((crc & mask) == mask)
+        job->candidates.push_back(p);
+      if (p + 1 >= job->last)
+        break;
+      crc = rollingCrc.Roll(crc, data[p - window], data[p]);
+    }
+    return 0;
+  }
+
+  // berechnet die CRCs der Chunks in [first, last)
+#if defined(WIN32)
+  static DWORD WINAPI
+#elif defined(__GNUC__)
+  static void*
+#endif
+  CrcThreadProc(void* lpParameter)
+  {
+    Job* job = reinterpret_cast<Job*>(lpParameter);
+    for (size_t i = job->first; i < job->last; ++i) {
+      Chunk& chunk = job->chunks[i];
+      chunk.crc = job->self->mCrcImpl.CrcDefault(job->data + chunk.offset, chunk.size, 0);
+    }
+    return 0;
+  }
+
+  const ROLLINGCRC& mRollingCrc;
+  const CRCIMPL& mCrcImpl;
+  const int mNumThreads;
+  const size_t mMinSize;
+  const size_t mMaxSize;
+  const Crc mMask;
+};
+
+
+#endif // __CHUNKER_H_
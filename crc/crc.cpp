@@ -3,6 +3,7 @@
 
 #if defined(WIN32)
 #include <Windows.h>
+#include <intrin.h>
 #include <nmmintrin.h>
 #endif
 
@@ -10,6 +11,7 @@
 #include <iomanip>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <getopt.h>
 #include <boost/crc.hpp>
 #include <limits.h>
@@ -18,10 +20,24 @@
 #include "stopwatch.h"
 #include "cpufeatures.h"
 #include "crc32.h"
+#include "crcclmul.h"
+#include "crc32cdispatch.h"
+#include "parallelcrc.h"
+#include "filecrc.h"
+#include "chunker.h"
 
 #include "crcutil-fast/crc32c_sse4.h"
+#include "crcutil-fast/crc32c_clmul.h"
+#include "crcutil-fast/crc64_clmul.h"
+#include "crcutil-fast/crc32c_interleaved.h"
+#include "crcutil-fast/crc32c_batch.h"
+#include "crcutil-fast/crc32c_copy.h"
+#include "crcutil-fast/crc32c_gather.h"
+#include "crcutil-fast/crc32c_sparse.h"
+#include "crcutil-fast/rolling_crc32c_avx2.h"
 #include "crcutil-fast/generic_crc.h"
 #include "crcutil-fast/protected_crc.h"
+#include "crcutil-fast/self_checking_crc.h"
 #include "crcutil-fast/rolling_crc.h"
 
 #if defined(__GNUC__)
@@ -42,6 +58,7 @@ static const int DEFAULT_ITERATIONS = 16;
 static const int DEFAULT_RNGBUF_SIZE = 128;
 static const int DEFAULT_NUM_THREADS = 1;
 static const int MAX_NUM_THREADS = 256;
+static const int CHUNK_WINDOW_SIZE = 48;
 
 enum CoreBinding {
   NoCoreBinding,
@@ -70,6 +87,21 @@ int gThreadIterations = 0;
 int gThreadPriority;
 int gNumSockets = 1;
 int gVerbose = 0;
+int gMessageSize = 0;
+bool gParallel = false;
+bool gSmallMessages = false;
+bool gBatch = false;
+bool gCopy = false;
+bool gChunks = false;
+bool gRolling = false;
+bool gCrc64 = false;
+bool gPolynomials = false;
+bool gSelfCheck = false;
+bool gSparse = false;
+bool gGather = false;
+bool gPatch = false;
+std::vector<size_t> gLatencySizes;
+const char* gFilename = NULL;
 CoreBinding gCoreBinding = AutomaticCoreBinding;
 
 struct CrcResult {
@@ -85,13 +117,43 @@ enum _long_options {
   SELECT_CORE_BINDING,
   SELECT_NUM_SOCKETS,
   SELECT_ITERATIONS,
-  SELECT_THREADS
+  SELECT_THREADS,
+  SELECT_PARALLEL,
+  SELECT_FILE,
+  SELECT_MESSAGE_SIZE,
+  SELECT_SMALL,
+  SELECT_BATCH,
+  SELECT_COPY,
+  SELECT_CHUNKS,
+  SELECT_ROLLING,
+  SELECT_CRC64,
+  SELECT_POLYNOMIALS,
+  SELECT_SELFCHECK,
+  SELECT_SPARSE,
+  SELECT_GATHER,
+  SELECT_PATCH,
+  SELECT_LATENCY
 };
 static struct option long_options[] = {
   { "core-binding",  required_argument, 0, SELECT_CORE_BINDING },
   { "sockets",       required_argument, 0, SELECT_NUM_SOCKETS },
   { "iterations",    required_argument, 0, SELECT_ITERATIONS },
   { "threads",       required_argument, 0, SELECT_THREADS },
+  { "parallel",      no_argument,       0, SELECT_PARALLEL },
+  { "file",          required_argument, 0, SELECT_FILE },
+  { "message-size",  required_argument, 0, SELECT_MESSAGE_SIZE },
+  { "small",         no_argument,       0, SELECT_SMALL },
+  { "batch",         no_argument,       0, SELECT_BATCH },
+  { "copy",          no_argument,       0, SELECT_COPY },
+  { "chunks",        no_argument,       0, SELECT_CHUNKS },
+  { "rolling",       no_argument,       0, SELECT_ROLLING },
+  { "crc64",         no_argument,       0, SELECT_CRC64 },
+  { "polynomials",   no_argument,       0, SELECT_POLYNOMIALS },
+  { "selfcheck",     no_argument,       0, SELECT_SELFCHECK },
+  { "sparse",        no_argument,       0, SELECT_SPARSE },
+  { "gather",        no_argument,       0, SELECT_GATHER },
+  { "patch",         no_argument,       0, SELECT_PATCH },
+  { "latency",       required_argument, 0, SELECT_LATENCY },
   { "help",          no_argument,       0, SELECT_HELP },
 };
 
@@ -101,11 +163,18 @@ enum Method {
   Intrinsic32,
 #if defined(_M_X64) || defined(__x86_64__)
   Intrinsic64,
+  Intrinsic64x3,
 #endif
   Boost,
   DefaultNaive,
   DefaultOptimized,
+  SlicingBy8,
+  SlicingBy16,
+  DefaultClmul,
   Crc32cSSE4,
+  Crc32cClmul,
+  Crc32cAvx512,
+  Dispatched,
 };
 
 struct BenchmarkResult {
@@ -125,6 +194,7 @@ struct BenchmarkResult {
   Method method;
   uint8_t* rngBuf;
   int rngBufSize;
+  int msgSize;
   int num;
   HANDLE hThread;
   int iterations;
@@ -191,79 +261,154 @@ void*
   int64_t tMin = LLONG_MAX;
   int64_t ticksMin = LLONG_MAX;
   uint32_t crc = 0;
-#if defined(_M_X64) || defined(__x86_64__)
-  uint64_t crc64 = 0;
-#endif
+  uint8_t* const buf = (uint8_t*)result->rngBuf + result->num * result->rngBufSize;
+  const uint8_t* const bufEnd = buf + result->rngBufSize;
+  const int msgSize = result->msgSize;
   for (int i = 0; i < result->iterations; ++i) {
     int64_t t, ticks;
     crc = 0;
-#if defined(_M_X64) || defined(__x86_64__)
-    crc64 = 0;
-#endif
     {
+      // Der Puffer wird in Nachrichten der Groesse msgSize zerlegt, deren
+      // CRCs per XOR verknuepft werden. Ohne --message-size gibt es nur
+      // eine einzige Nachricht, die den gesamten Puffer umfasst.
       Stopwatch stopwatch(t, ticks);
       switch (result->method)
       {
       case Intrinsic8:
         {
-          uint8_t* rn = (uint8_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint8_t);
-          const uint8_t* const rne = (uint8_t*)rn + result->rngBufSize / sizeof(uint8_t);
-          while (rn < rne)
-            crc = _mm_crc32_u8(crc, *rn++);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            const uint8_t* rn = msg;
+            const uint8_t* const rne = rn + msgSize / sizeof(uint8_t);
+            uint32_t crcMsg = 0;
+            while (rn < rne)
+              crcMsg = _mm_crc32_u8(crcMsg, *rn++);
+            crc ^= crcMsg;
+          }
           break;
         }
       case Intrinsic16:
         {
-          uint16_t* rn = (uint16_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint16_t);
-          const uint16_t* const rne = (uint16_t*)rn + result->rngBufSize / sizeof(uint16_t);
-          while (rn < rne)
-            crc = _mm_crc32_u16(crc, *rn++);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            const uint16_t* rn = (const uint16_t*)msg;
+            const uint16_t* const rne = rn + msgSize / sizeof(uint16_t);
+            uint32_t crcMsg = 0;
+            while (rn < rne)
+              crcMsg = _mm_crc32_u16(crcMsg, *rn++);
+            crc ^= crcMsg;
+          }
           break;
         }
       case Intrinsic32:
         {
-          uint32_t* rn = (uint32_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint32_t);
-          const uint32_t* const rne = rn + result->rngBufSize / sizeof(uint32_t);
-          while (rn < rne)
-            crc = _mm_crc32_u32(crc, *rn++);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            const uint32_t* rn = (const uint32_t*)msg;
+            const uint32_t* const rne = rn + msgSize / sizeof(uint32_t);
+            uint32_t crcMsg = 0;
+            while (rn < rne)
+              crcMsg = _mm_crc32_u32(crcMsg, *rn++);
+            crc ^= crcMsg;
+          }
           break;
         }
 #if defined(_M_X64) || defined(__x86_64__)
       case Intrinsic64:
         {
-          uint64_t* rn = (uint64_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint64_t);
-          const uint64_t* const rne = rn + result->rngBufSize / sizeof(uint64_t);
-          while (rn < rne)
-            crc64 = _mm_crc32_u64(crc64, *rn++);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            const uint64_t* rn = (const uint64_t*)msg;
+            const uint64_t* const rne = rn + msgSize / sizeof(uint64_t);
+            uint64_t crcMsg = 0;
+            while (rn < rne)
+              crcMsg = _mm_crc32_u64(crcMsg, *rn++);
+            crc ^= (uint32_t)(crcMsg & 0xffffffffU);
+          }
+          break;
+        }
+      case Intrinsic64x3:
+        {
+          crcutil::Crc32cInterleaved crc32(false);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize)
+            crc ^= (uint32_t)crc32.CrcDefault(msg, msgSize, 0U);
           break;
         }
 #endif
       case Boost:
         {
-          uint32_t* rn = (uint32_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint32_t);
-          boost::crc_optimal<32U, 0x1edc6f41U, 0U, 0U, true, true> crcBoost;
-          crcBoost.process_bytes(rn, result->rngBufSize);
-          crc = crcBoost.checksum();
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            boost::crc_optimal<32U, 0x1edc6f41U, 0U, 0U, true, true> crcBoost;
+            crcBoost.process_bytes(msg, msgSize);
+            crc ^= crcBoost.checksum();
+          }
           break;
         }
       case DefaultNaive:
         {
-          uint8_t* rn = (uint8_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint8_t);
-          CRC32Naive<0U, 0x1edc6f41U, true> crc32c;
-          crc = crc32c.process(rn, result->rngBufSize);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            CRC32Naive<0U, 0x1edc6f41U, true> crc32c;
+            crc ^= crc32c.process(msg, msgSize);
+          }
           break;
         }
       case DefaultOptimized:
         {
-          uint8_t* rn = (uint8_t*)result->rngBuf + result->num * result->rngBufSize / sizeof(uint8_t);
-          CRC32Optimized<0U, 0x1edc6f41U, true> crc32c;
-          crc = crc32c.process(rn, result->rngBufSize);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            CRC32Optimized<0U, 0x1edc6f41U, true> crc32c;
+            crc ^= crc32c.process(msg, msgSize);
+          }
+          break;
+        }
+      case SlicingBy8:
+        {
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            CRC32SlicingBy8<0U, 0x1edc6f41U, true> crc32c;
+            crc ^= crc32c.process(msg, msgSize);
+          }
+          break;
+        }
+      case SlicingBy16:
+        {
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            CRC32SlicingBy16<0U, 0x1edc6f41U, true> crc32c;
+            crc ^= crc32c.process(msg, msgSize);
+          }
+          break;
+        }
+      case DefaultClmul:
+        {
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize) {
+            CRC32Clmul<0U, 0x1edc6f41U, true> crc32c;
+            crc ^= crc32c.process(msg, msgSize);
+          }
           break;
         }
       case Crc32cSSE4:
         {
           crcutil::Crc32cSSE4 crc32(false);
-          crc = (uint32_t)crc32.CrcDefault((uint8_t*)result->rngBuf + result->num * result->rngBufSize, result->rngBufSize, 0U);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize)
+            crc ^= (uint32_t)crc32.CrcDefault(msg, msgSize, 0U);
+          break;
+        }
+      case Crc32cClmul:
+        {
+          crcutil::Crc32cClmul crc32(false);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize)
+            crc ^= (uint32_t)crc32.CrcDefault(msg, msgSize, 0U);
+          break;
+        }
+      case Crc32cAvx512:
+        {
+          crcutil::Crc32cClmul crc32(false, crcutil::Crc32cClmul::kVpclmul512);
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize)
+            crc ^= (uint32_t)crc32.CrcDefault(msg, msgSize, 0U);
+          break;
+        }
+      case Dispatched:
+        {
+          // die Fassade rechnet mit Startwert 0xffffffff und invertiert das
+          // Ergebnis (wie crcutil mit canonical = true); so ergibt sich
+          // derselbe CRC wie bei den anderen Verfahren mit Startwert 0
+          const Crc32cFunction crc32c = Crc32cDispatcher::instance().function();
+          for (const uint8_t* msg = buf; msg + msgSize <= bufEnd; msg += msgSize)
+            crc ^= ~crc32c(msg, msgSize, ~0U);
           break;
         }
       }
@@ -275,11 +420,7 @@ void*
   }
   result->t = tMin;
   result->ticks = ticksMin;
-#if defined(_M_X64) || defined(__x86_64__)
-  result->crc = (result->method == Intrinsic64)? (uint32_t)(crc64 & 0xffffffffU) : crc;
-#else
   result->crc = crc;
-#endif
   return EXIT_SUCCESS;
 }
 
@@ -299,6 +440,7 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
     pResult[i].num = i;
     pResult[i].rngBuf = gRngBuf;
     pResult[i].rngBufSize = gRngBufSize;
+    pResult[i].msgSize = (gMessageSize > 0 && gMessageSize < gRngBufSize)? gMessageSize : gRngBufSize;
     pResult[i].iterations = gIterations;
     pResult[i].numCores = numCores;
     pResult[i].coreBinding = gCoreBinding;
@@ -348,6 +490,1173 @@ void runBenchmark(int numThreads, const char* strMethod, const Method method) {
 }
 
 
+// CRC ueber den gesamten Puffer mit numThreads Threads berechnen
+// und mit dem seriell berechneten Ergebnis vergleichen
+bool runParallelBenchmark(int numThreads, const crcutil::Crc32cSSE4& crcImpl, uint32_t serialCrc) {
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize;
+  ParallelCrc<crcutil::Crc32cSSE4> parallelCrc(crcImpl, numThreads);
+  std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+  std::cout << "  " << std::setfill(' ') << std::setw(7) << numThreads << "  ";
+  int64_t tMin = LLONG_MAX;
+  uint32_t crc = 0;
+  for (int i = 0; i < gIterations; ++i) {
+    int64_t t, ticks;
+    {
+      Stopwatch stopwatch(t, ticks);
+      crc = (uint32_t)parallelCrc.process(gRngBuf, bytes, 0U);
+    }
+    if (t < tMin)
+      tMin = t;
+  }
+  std::cout << "0x" << std::setfill('0') << std::hex << std::setw(8) << crc
+    << std::setfill(' ') << std::setw(10) << std::dec << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+    << std::fixed << std::setprecision(2) << std::setw(8)
+    << (float)bytes/1024/1024/((float)tMin/Stopwatch::RESOLUTION) << " MB/s"
+    << "  " << ((crc == serialCrc)? "OK" : "FEHLER") << std::endl;
+  return crc == serialCrc;
+}
+
+
+// viele kleine Nachrichten unterschiedlicher Laenge einzeln und gebuendelt
+// pruefen; die Laengen streuen um +/-25% um die Nenngroesse, damit die
+// Nachrichten in Crc32cBatch nicht gleichzeitig fertig werden
+bool runBatchBenchmark(void) {
+  static const int BATCH_MESSAGE_SIZES[] = { 64, 128, 256, 512, 1024 };
+  static const size_t BATCH_SIZE = 1024;
+  // die Nachrichten stammen aus den ersten 256 KByte des Puffers, damit sie
+  // im L2-Cache liegen und nicht die Speicherbandbreite gemessen wird;
+  // Stopwatch misst unter Linux nur Millisekunden: jeden Durchgang mehrfach wiederholen
+  static const size_t BATCH_BUFFER_SIZE = 256 * 1024;
+  static const int BATCH_REPETITIONS = 256;
+  crcutil::Crc32cSSE4 crcImpl(false);
+  crcutil::Crc32cBatch batchImpl(false);
+  const size_t bufSize = std::min((size_t)gMaxNumThreads * gRngBufSize, BATCH_BUFFER_SIZE);
+  std::vector<crcutil::Crc32cBatch::Buffer> buffers;
+  std::vector<crcutil::Crc32cBatch::Crc> serialCrcs, batchCrcs;
+  bool correct = true;
+  std::cout << std::endl
+    << "Nachrichten einzeln (Crc32cSSE4) und gebuendelt (Crc32cBatch):" << std::endl
+    << std::endl
+    << "  Bytes    einzeln                     gebuendelt                  Faktor" << std::endl
+    << "  ----------------------------------------------------------------------" << std::endl;
+  for (size_t j = 0; j < sizeof(BATCH_MESSAGE_SIZES) / sizeof(BATCH_MESSAGE_SIZES[0]); ++j) {
+    const size_t msgSize = BATCH_MESSAGE_SIZES[j];
+    buffers.clear();
+    size_t totalBytes = 0;
+    for (size_t offset = 0; offset + msgSize + msgSize / 4 <= bufSize; ) {
+      const size_t bytes = msgSize - msgSize / 4 + gRngBuf[offset] % (msgSize / 2 + 1);
+      crcutil::Crc32cBatch::Buffer buffer = { gRngBuf + offset, bytes };
+      buffers.push_back(buffer);
+      totalBytes += bytes;
+      offset += bytes;
+    }
+    const size_t numMessages = buffers.size();
+    serialCrcs.resize(numMessages);
+    batchCrcs.resize(numMessages);
+    int64_t tSerial = LLONG_MAX, tBatch = LLONG_MAX;
+    for (int i = 0; i < gIterations; ++i) {
+      int64_t t, ticks;
+      {
+        Stopwatch stopwatch(t, ticks);
+        for (int r = 0; r < BATCH_REPETITIONS; ++r)
+          for (size_t k = 0; k < numMessages; ++k)
+            serialCrcs[k] = crcImpl.CrcDefault(buffers[k].data, buffers[k].bytes, 0);
+      }
+      if (t < tSerial)
+        tSerial = t;
+      {
+        Stopwatch stopwatch(t, ticks);
+        for (int r = 0; r < BATCH_REPETITIONS; ++r)
+          for (size_t k = 0; k < numMessages; k += BATCH_SIZE)
+            batchImpl.CrcBatch(&buffers[k], std::min(BATCH_SIZE, numMessages - k), 0, &batchCrcs[k]);
+      }
+      if (t < tBatch)
+        tBatch = t;
+    }
+    if (tSerial <= 0)
+      tSerial = 1;
+    if (tBatch <= 0)
+      tBatch = 1;
+    const double sSerial = (double)tSerial / Stopwatch::RESOLUTION / BATCH_REPETITIONS;
+    const double sBatch = (double)tBatch / Stopwatch::RESOLUTION / BATCH_REPETITIONS;
+    const bool ok = (serialCrcs == batchCrcs);
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(5) << msgSize << "  "
+      << std::fixed << std::setprecision(2)
+      << std::setw(8) << (double)numMessages/1e6/sSerial << " Mio./s "
+      << std::setw(8) << (double)totalBytes/1024/1024/sSerial << " MB/s  "
+      << std::setw(8) << (double)numMessages/1e6/sBatch << " Mio./s "
+      << std::setw(8) << (double)totalBytes/1024/1024/sBatch << " MB/s  "
+      << std::setw(6) << sSerial/sBatch
+      << "  " << (ok? "OK" : "FEHLER") << std::endl;
+  }
+  return correct;
+}
+
+
+// Bloecke kopieren und pruefen: erst memcpy(), dann CRC, gegen Crc32cCopy
+bool runCopyBenchmark(void) {
+  static const size_t COPY_BLOCK_SIZES[] = { 4 * 1024, 64 * 1024, 1024 * 1024, 0 };
+  const size_t bufSize = (size_t)gMaxNumThreads * gRngBufSize;
+  uint8_t* dst = new uint8_t[bufSize];
+  crcutil::Crc32cSSE4 crcImpl(false);
+  crcutil::Crc32cCopy copyImpl(false);
+  bool correct = true;
+  std::cout << std::endl
+    << "Kopieren und CRC bilden (" << (bufSize/1024/1024) << " MByte in Bloecken):" << std::endl
+    << std::endl
+    << "  Block      memcpy + CRC      Crc32cCopy        Crc32cCopy/NT" << std::endl
+    << "  --------------------------------------------------------------------" << std::endl;
+  for (size_t j = 0; j < sizeof(COPY_BLOCK_SIZES) / sizeof(COPY_BLOCK_SIZES[0]); ++j) {
+    // 0 steht fuer den gesamten Puffer in einem Stueck
+    const size_t blockSize = (COPY_BLOCK_SIZES[j] == 0 || COPY_BLOCK_SIZES[j] > bufSize)? bufSize : COPY_BLOCK_SIZES[j];
+    const size_t numBlocks = bufSize / blockSize;
+    int64_t tMin[3] = { LLONG_MAX, LLONG_MAX, LLONG_MAX };
+    uint32_t crc[3] = { 0, 0, 0 };
+    bool ok = true;
+    for (int m = 0; m < 3; ++m) {
+      for (int i = 0; i < gIterations; ++i) {
+        memset(dst, 0, bufSize);
+        int64_t t, ticks;
+        uint32_t c = 0;
+        {
+          Stopwatch stopwatch(t, ticks);
+          for (size_t k = 0; k < numBlocks; ++k) {
+            const uint8_t* const src = gRngBuf + k * blockSize;
+            uint8_t* const d = dst + k * blockSize;
+            if (m == 0) {
+              memcpy(d, src, blockSize);
+              c ^= (uint32_t)crcImpl.CrcDefault(d, blockSize, 0);
+            }
+            else {
+              c ^= (uint32_t)copyImpl.CrcCopy(d, src, blockSize, 0, m == 2);
+            }
+          }
+        }
+        if (t < tMin[m])
+          tMin[m] = t;
+        crc[m] = c;
+      }
+      ok = ok && memcmp(dst, gRngBuf, numBlocks * blockSize) == 0 && crc[m] == crc[0];
+    }
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(5) << (blockSize/1024) << " KB "
+      << std::fixed << std::setprecision(2);
+    for (int m = 0; m < 3; ++m) {
+      if (tMin[m] <= 0)
+        tMin[m] = 1;
+      std::cout << std::setw(10) << (double)numBlocks*blockSize/1024/1024/1024/((double)tMin[m]/Stopwatch::RESOLUTION) << " GB/s  ";
+    }
+    std::cout << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  delete [] dst;
+  return correct;
+}
+
+
+// Block mit den mit -t angegebenen Anzahlen von Threads in Chunks zerlegen;
+// die Ergebnisse muessen unabhaengig von der Anzahl der Threads sein, und
+// die verknuepften CRCs aller Chunks muessen den CRC des Blocks ergeben
+bool runChunkBenchmark(const uint8_t* data, size_t bytes) {
+  typedef Chunker<crcutil::RollingCrc32cSSE4, crcutil::Crc32cSSE4> ChunkerType;
+  crcutil::Crc32cSSE4 crcImpl(false);
+  crcutil::RollingCrc32cSSE4 rollingCrc(crcImpl, CHUNK_WINDOW_SIZE, 0);
+  const uint32_t blockCrc = (uint32_t)crcImpl.CrcDefault(data, bytes, 0);
+  std::vector<ChunkerType::Chunk> reference;
+  bool correct = true;
+  std::cout << std::endl
+    << "Zerlegen von " << (bytes/1024/1024) << " MByte in Chunks (Fenster " << CHUNK_WINDOW_SIZE << " Bytes, "
+    << (ChunkerType::DEFAULT_MIN_SIZE/1024) << " bis " << (ChunkerType::DEFAULT_MAX_SIZE/1024) << " KByte):" << std::endl
+    << std::endl
+    << "  Threads   Chunks  Mittel (Bytes)      t/Block      Durchsatz" << std::endl
+    << "  ------------------------------------------------------------" << std::endl;
+  for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 ; ++i) {
+    const int numThreads = gNumThreads[i];
+    ChunkerType chunker(rollingCrc, crcImpl, numThreads);
+    std::vector<ChunkerType::Chunk> chunks;
+    int64_t tMin = LLONG_MAX;
+    for (int j = 0; j < gIterations; ++j) {
+      chunks.clear();
+      int64_t t, ticks;
+      {
+        Stopwatch stopwatch(t, ticks);
+        chunker.process(data, bytes, chunks);
+      }
+      if (t < tMin)
+        tMin = t;
+    }
+    if (tMin <= 0)
+      tMin = 1;
+    // Chunks pruefen: lueckenlos, gleich fuer alle Thread-Anzahlen, CRCs passen zum Block
+    bool ok = !chunks.empty() || bytes == 0;
+    uint32_t crc = 0;
+    uint64_t offset = 0;
+    for (size_t k = 0; k < chunks.size() && ok; ++k) {
+      ok = chunks[k].offset == offset;
+      offset += chunks[k].size;
+      crc = (uint32_t)crcImpl.Base().Concatenate(crc, chunks[k].crc, chunks[k].size);
+    }
+    ok = ok && offset == bytes && crc == blockCrc;
+    if (reference.empty())
+      reference = chunks;
+    ok = ok && chunks.size() == reference.size();
+    for (size_t k = 0; k < chunks.size() && ok; ++k)
+      ok = chunks[k].offset == reference[k].offset && chunks[k].size == reference[k].size && chunks[k].crc == reference[k].crc;
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(7) << numThreads
+      << std::setw(9) << chunks.size()
+      << std::setw(16) << (chunks.empty()? 0 : bytes / chunks.size())
+      << std::setw(10) << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+      << std::fixed << std::setprecision(2) << std::setw(8)
+      << (double)bytes/1024/1024/((double)tMin/Stopwatch::RESOLUTION) << " MB/s"
+      << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  return correct;
+}
+
+
+// rollenden CRC an jeder Position des Puffers bilden und moegliche
+// Chunk-Grenzen als Bitmap markieren: Roll() gegen AVX2-Gathers
+bool runRollingBenchmark(void) {
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize;
+  const size_t first = CHUNK_WINDOW_SIZE;
+  const size_t mask = Chunker<crcutil::RollingCrc32cSSE4, crcutil::Crc32cSSE4>::DEFAULT_MASK;
+  const size_t numWords = (bytes - first + 63) / 64;
+  crcutil::Crc32cSSE4 crcImpl(false);
+  crcutil::RollingCrc32cSSE4 rollingSSE4(crcImpl, CHUNK_WINDOW_SIZE, 0);
+  crcutil::RollingCrc32cAvx2 rollingAvx2(crcImpl, CHUNK_WINDOW_SIZE, 0);
+  std::vector<uint64_t> reference(numWords), bitmap(numWords);
+  const bool avx2 = crcutil::RollingCrc32cAvx2::HasAvx2Backend() && CPUFeatures::instance().isAVX2Supported();
+  bool correct = true;
+  std::cout << std::endl
+    << "Rollender CRC ueber " << CHUNK_WINDOW_SIZE << " Bytes an " << (bytes/1024/1024) << " MByte Positionen:" << std::endl
+    << std::endl
+    << "  Methode                   Grenzen      t/Block      Durchsatz" << std::endl
+    << "  -------------------------------------------------------------" << std::endl;
+  for (int m = 0; m < 3; ++m) {
+    static const char* METHOD_NAMES[] = { "RollingCrc32cSSE4", "RollingCrc32cAvx2 skalar", "RollingCrc32cAvx2" };
+    if (m == 2 && !avx2)
+      break;
+    std::vector<uint64_t>& result = (m == 0)? reference : bitmap;
+    int64_t tMin = LLONG_MAX;
+    for (int i = 0; i < gIterations; ++i) {
+      int64_t t, ticks;
+      {
+        Stopwatch stopwatch(t, ticks);
+        switch (m) {
+        case 0:
+          {
+            // so wuerde man Roll() ohne SIMD einsetzen
+            std::fill(result.begin(), result.end(), 0);
+            size_t crc = rollingSSE4.Start(gRngBuf);
+            for (size_t p = first; ; ++p) {
+              if ((crc & mask) == mask)
+                result[(p - first) / 64] |= (uint64_t)1 << ((p - first) % 64);
+              if (p + 1 >= bytes)
+                break;
+              crc = rollingSSE4.Roll(crc, gRngBuf[p - first], gRngBuf[p]);
+            }
+            break;
+          }
+        case 1:
+          rollingAvx2.FindCandidatesScalar(gRngBuf, first, bytes, mask, &result[0]);
+          break;
+        case 2:
+          rollingAvx2.FindCandidates(gRngBuf, first, bytes, mask, &result[0]);
+          break;
+        }
+      }
+      if (t < tMin)
+        tMin = t;
+    }
+    if (tMin <= 0)
+      tMin = 1;
+    size_t numCandidates = 0;
+    for (size_t k = 0; k < numWords; ++k)
+      for (uint64_t w = result[k]; w != 0; w &= w - 1)
+        ++numCandidates;
+    const bool ok = (result == reference);
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(24) << METHOD_NAMES[m];
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << std::setw(8) << numCandidates
+      << std::setw(10) << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+      << std::fixed << std::setprecision(2) << std::setw(8)
+      << (double)bytes/1024/1024/((double)tMin/Stopwatch::RESOLUTION) << " MB/s"
+      << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  return correct;
+}
+
+
+// CRC64 ueber alle Bloecke bilden, tabellengesteuert gegen PCLMULQDQ;
+// beide Verfahren muessen denselben CRC und den Pruefwert ueber
+// "123456789" aus der jeweiligen Spezifikation liefern
+bool runCrc64Benchmark(void) {
+  typedef crcutil::GenericCrc<crcutil::uint64, crcutil::uint64, crcutil::uint64, 4> GenericCrc64;
+  struct Crc64Polynomial {
+    const char* name;
+    crcutil::uint64 poly;
+    crcutil::uint64 check;
+  };
+  static const Crc64Polynomial CRC64_POLYNOMIALS[] = {
+    { "ECMA-182", crcutil::Crc64Clmul::Ecma182Polynomial(), 0x995dc9bbdf1939faULL },
+    { "NVMe",     crcutil::Crc64Clmul::NvmePolynomial(),    0xae8b14860a799888ULL }
+  };
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize;
+  const bool clmul = CPUFeatures::instance().isCRCSupported() && CPUFeatures::instance().isClmulSupported();
+  bool correct = true;
+  std::cout << std::endl
+    << "CRC64 ueber " << (bytes/1024/1024) << " MByte:" << std::endl
+    << std::endl
+    << "  Polynom   Methode       CRC                     t/Block      Durchsatz  Zyklen" << std::endl
+    << "  ------------------------------------------------------------------------------" << std::endl;
+  for (size_t j = 0; j < sizeof(CRC64_POLYNOMIALS) / sizeof(CRC64_POLYNOMIALS[0]); ++j) {
+    const Crc64Polynomial& p = CRC64_POLYNOMIALS[j];
+    GenericCrc64 genericImpl(p.poly, 64, true);
+    crcutil::Crc64Clmul clmulImpl(p.poly, 64, true);
+    crcutil::uint64 reference = 0;
+    double tReference = 0;
+    for (int m = 0; m < 2; ++m) {
+      static const char* METHOD_NAMES[] = { "GenericCrc", "Crc64Clmul" };
+      if (m == 1 && !clmul)
+        break;
+      crcutil::uint64 crc = 0, check = 0;
+      int64_t tMin = LLONG_MAX, ticksMin = LLONG_MAX;
+      for (int i = 0; i < gIterations; ++i) {
+        int64_t t, ticks;
+        {
+          Stopwatch stopwatch(t, ticks);
+          crc = (m == 0)? genericImpl.CrcDefault(gRngBuf, bytes, 0) : clmulImpl.CrcDefault(gRngBuf, bytes, 0);
+        }
+        if (t < tMin)
+          tMin = t;
+        if (ticks < ticksMin)
+          ticksMin = ticks;
+      }
+      if (tMin <= 0)
+        tMin = 1;
+      check = (m == 0)? genericImpl.CrcDefault("123456789", 9, 0) : clmulImpl.CrcDefault("123456789", 9, 0);
+      if (m == 0) {
+        reference = crc;
+        tReference = (double)tMin;
+      }
+      const bool ok = (crc == reference && check == p.check);
+      correct = correct && ok;
+      std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+      std::cout << "  " << std::setfill(' ') << std::setw(10) << ((m == 0)? p.name : "") << std::setw(12) << METHOD_NAMES[m];
+      std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+      std::cout << "  0x" << std::setfill('0') << std::hex << std::setw(16) << crc
+        << std::setfill(' ') << std::dec << std::setw(10) << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+        << std::fixed << std::setprecision(2) << std::setw(8)
+        << (double)bytes/1024/1024/((double)tMin/Stopwatch::RESOLUTION) << " MB/s"
+        << std::setw(8) << (double)ticksMin / bytes;
+      if (m > 0)
+        std::cout << "  (" << tReference / tMin << "x)";
+      std::cout << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+    }
+  }
+  return correct;
+}
+
+
+// CRC ueber alle Bloecke mit einem Polynom von WIDTH Bit bilden:
+// GenericCrc gegen Crc64Clmul und CLMUL (CRCClmul<> mit demselben Polynom);
+// alle muessen denselben CRC und den Pruefwert ueber "123456789" liefern
+template <class CLMUL, int WIDTH>
+bool runPolynomialBenchmark(const char* strName, uint64_t v0, uint64_t xorOut, uint64_t check) {
+  typedef crcutil::GenericCrc<crcutil::uint64, crcutil::uint64, crcutil::uint64, 4> GenericCrc64;
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize;
+  const bool clmul = CPUFeatures::instance().isCRCSupported() && CPUFeatures::instance().isClmulSupported();
+  const uint64_t poly = CLMUL::EFFECTIVE_POLYNOMIAL;
+  GenericCrc64 genericImpl(poly, WIDTH, false);
+  crcutil::Crc64Clmul clmulImpl(poly, WIDTH, false);
+  uint64_t reference = 0;
+  double tReference = 0;
+  bool correct = true;
+  for (int m = 0; m < 3; ++m) {
+    static const char* METHOD_NAMES[] = { "GenericCrc", "Crc64Clmul", "CRCClmul<>" };
+    if (m > 0 && !clmul)
+      break;
+    uint64_t crc = 0, checkCrc = 0;
+    int64_t tMin = LLONG_MAX, ticksMin = LLONG_MAX;
+    for (int i = 0; i < gIterations; ++i) {
+      int64_t t, ticks;
+      {
+        Stopwatch stopwatch(t, ticks);
+        switch (m) {
+        case 0:
+          crc = genericImpl.CrcDefault(gRngBuf, bytes, v0);
+          break;
+        case 1:
+          crc = clmulImpl.CrcDefault(gRngBuf, bytes, v0);
+          break;
+        case 2:
+          {
+            CLMUL crcImpl;
+            crc = crcImpl.process(gRngBuf, (int)bytes);
+            break;
+          }
+        }
+      }
+      if (t < tMin)
+        tMin = t;
+      if (ticks < ticksMin)
+        ticksMin = ticks;
+    }
+    if (tMin <= 0)
+      tMin = 1;
+    switch (m) {
+    case 0:
+      checkCrc = genericImpl.CrcDefault("123456789", 9, v0);
+      break;
+    case 1:
+      checkCrc = clmulImpl.CrcDefault("123456789", 9, v0);
+      break;
+    case 2:
+      {
+        CLMUL crcImpl;
+        checkCrc = crcImpl.process(reinterpret_cast<const uint8_t*>("123456789"), 9);
+        break;
+      }
+    }
+    if (m == 0) {
+      reference = crc;
+      tReference = (double)tMin;
+    }
+    const bool ok = (crc == reference && (checkCrc ^ xorOut) == check);
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(10) << ((m == 0)? strName : "") << std::setw(12) << METHOD_NAMES[m];
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  0x" << std::setfill('0') << std::hex << std::setw((WIDTH + 3) / 4) << (crc ^ xorOut)
+      << std::setfill(' ') << std::dec << std::setw(10 + 16 - (WIDTH + 3) / 4) << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+      << std::fixed << std::setprecision(2) << std::setw(8)
+      << (double)bytes/1024/1024/((double)tMin/Stopwatch::RESOLUTION) << " MB/s"
+      << std::setw(8) << (double)ticksMin / bytes;
+    if (m > 0)
+      std::cout << "  (" << tReference / tMin << "x)";
+    std::cout << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  return correct;
+}
+
+
+bool runPolynomialBenchmarks(void) {
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize;
+  std::cout << std::endl
+    << "CRCs mit verschiedenen Polynomen ueber " << (bytes/1024/1024) << " MByte:" << std::endl
+    << std::endl
+    << "  Polynom   Methode       CRC                     t/Block      Durchsatz  Zyklen" << std::endl
+    << "  ------------------------------------------------------------------------------" << std::endl;
+  bool correct = true;
+  correct = runPolynomialBenchmark<CRCClmul<16, 0U, 0x8005U, true>, 16>("CRC-16", 0U, 0U, 0xbb3dU) && correct;
+  correct = runPolynomialBenchmark<CRCClmul<32, 0xffffffffU, 0x04c11db7U, true>, 32>("CRC-32", 0xffffffffU, 0xffffffffU, 0xcbf43926U) && correct;
+  correct = runPolynomialBenchmark<CRCClmul<32, 0xffffffffU, 0x1edc6f41U, true>, 32>("CRC-32C", 0xffffffffU, 0xffffffffU, 0xe3069283U) && correct;
+  correct = runPolynomialBenchmark<CRCClmul<64, ~0ULL, 0x42f0e1eba9ea3693ULL, true>, 64>("CRC-64", ~0ULL, ~0ULL, 0x995dc9bbdf1939faULL) && correct;
+  return correct;
+}
+
+
+// CRC32C ueber alle Bloecke in Nachrichten zu SELFCHECK_MESSAGE_SIZE Bytes
+// bilden, ohne und mit automatischer Selbstpruefung der Tabellen
+// (SelfCheckingCrc), und mit einer vollstaendigen Pruefung pro MByte zum
+// Vergleich; anschliessend ein Tabellenbyte verfaelschen, um zu zeigen,
+// dass die Selbstpruefung den Fehler bemerkt
+static const size_t SELFCHECK_MESSAGE_SIZE = 4096;
+
+bool runSelfCheckBenchmark(void) {
+  typedef crcutil::GenericCrc<crcutil::uint64, crcutil::uint64, crcutil::uint64, 4> GenericCrc64;
+  typedef crcutil::ProtectedCrc<GenericCrc64> ProtectedGenericCrc;
+  typedef crcutil::SelfCheckingCrc<GenericCrc64> SelfCheckingGenericCrc;
+  static const crcutil::uint64 BUDGETS[] = { 64 * 1024, 1024 * 1024 };
+  const size_t bytes = (size_t)gMaxNumThreads * gRngBufSize / SELFCHECK_MESSAGE_SIZE * SELFCHECK_MESSAGE_SIZE;
+  ProtectedGenericCrc protectedImpl;
+  protectedImpl.Init(crcutil::Crc32cSSE4::FixedGeneratingPolynomial(), crcutil::Crc32cSSE4::FixedDegree(), true);
+  // in einer echten Anwendung stammt der Pruefwert aus einer Konstanten,
+  // die auf einem Rechner mit intakten Tabellen ermittelt wurde
+  const crcutil::uint64 checkValue = protectedImpl.SelfCheckValue();
+  std::cout << std::endl
+    << "CRC32C mit Selbstpruefung der Tabellen (" << sizeof(ProtectedGenericCrc) << " Bytes) ueber "
+    << (bytes/1024/1024) << " MByte in Nachrichten zu " << SELFCHECK_MESSAGE_SIZE << " Bytes:" << std::endl
+    << std::endl
+    << "  Pruefung        CRC            t/Block      Durchsatz  max. Zyklen/Aufruf  Pruefungen" << std::endl
+    << "  -------------------------------------------------------------------------------------" << std::endl;
+  crcutil::uint64 reference = 0;
+  double tReference = 0;
+  bool correct = true;
+  for (int m = 0; m < 4; ++m) {
+    static const char* METHOD_NAMES[] = { "keine", "alle 64 KByte", "alle 1 MByte", "1 MByte am Stueck" };
+    crcutil::uint64 crc = 0;
+    crcutil::uint64 checks = 0, failures = 0;
+    int64_t tMin = LLONG_MAX, ticksMax = 0;
+    // in den zweiten gIterations Durchgaengen die Dauer jedes einzelnen
+    // Aufrufs messen; das Minimum je Aufruf blendet Unterbrechungen aus
+    std::vector<int64_t> callTicks(bytes / SELFCHECK_MESSAGE_SIZE, LLONG_MAX);
+    for (int i = 0; i < 2 * gIterations; ++i) {
+      const bool measureCalls = (i >= gIterations);
+      SelfCheckingGenericCrc selfChecking(protectedImpl, checkValue, (m == 1)? BUDGETS[0] : BUDGETS[1]);
+      crcutil::uint64 sinceCheck = 0;
+      checks = 0;
+      failures = 0;
+      int64_t t, ticks;
+      {
+        Stopwatch stopwatch(t, ticks);
+        crc = 0;
+        for (size_t offset = 0; offset < bytes; offset += SELFCHECK_MESSAGE_SIZE) {
+          const int64_t ticks0 = measureCalls? (int64_t)__rdtsc() : 0;
+          switch (m) {
+          case 0:
+            crc ^= protectedImpl.CrcDefault(gRngBuf + offset, SELFCHECK_MESSAGE_SIZE, 0);
+            break;
+          case 1:
+            // fall-through
+          case 2:
+            crc ^= selfChecking.CrcDefault(gRngBuf + offset, SELFCHECK_MESSAGE_SIZE, 0);
+            break;
+          case 3:
+            crc ^= protectedImpl.CrcDefault(gRngBuf + offset, SELFCHECK_MESSAGE_SIZE, 0);
+            sinceCheck += SELFCHECK_MESSAGE_SIZE;
+            if (sinceCheck >= BUDGETS[1]) {
+              sinceCheck = 0;
+              ++checks;
+              if (protectedImpl.SelfCheckValue() != checkValue)
+                ++failures;
+            }
+            break;
+          }
+          if (measureCalls) {
+            const int64_t ticksCall = (int64_t)__rdtsc() - ticks0;
+            int64_t& ticksMinCall = callTicks[offset / SELFCHECK_MESSAGE_SIZE];
+            if (ticksCall < ticksMinCall)
+              ticksMinCall = ticksCall;
+          }
+        }
+      }
+      if (measureCalls) {
+        if (m == 1 || m == 2) {
+          checks = selfChecking.Checks();
+          failures = selfChecking.Failures();
+        }
+      }
+      else if (t < tMin) {
+        tMin = t;
+      }
+    }
+    if (tMin <= 0)
+      tMin = 1;
+    for (size_t k = 0; k < callTicks.size(); ++k)
+      if (callTicks[k] > ticksMax)
+        ticksMax = callTicks[k];
+    if (m == 0) {
+      reference = crc;
+      tReference = (double)tMin;
+    }
+    const bool ok = (crc == reference && failures == 0);
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(18) << METHOD_NAMES[m];
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "0x" << std::setfill('0') << std::hex << std::setw(8) << (uint32_t)crc
+      << std::setfill(' ') << std::dec << std::setw(10) << (1000*tMin/Stopwatch::RESOLUTION) << " ms  "
+      << std::fixed << std::setprecision(2) << std::setw(8)
+      << (double)bytes/1024/1024/((double)tMin/Stopwatch::RESOLUTION) << " MB/s"
+      << std::setw(20) << ticksMax << std::setw(12) << checks;
+    if (m > 0)
+      std::cout << "  (" << std::setprecision(1) << 100 * ((double)tMin / tReference - 1) << "%)";
+    std::cout << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+
+  // ein Bit in der Mitte der Tabellen kippen: die Selbstpruefung muss
+  // spaetestens nach 64 KByte anschlagen
+  crcutil::uint8* tableBytes = reinterpret_cast<crcutil::uint8*>(&protectedImpl);
+  tableBytes[sizeof(ProtectedGenericCrc) / 2] ^= 0x10;
+  SelfCheckingGenericCrc selfChecking(protectedImpl, checkValue, BUDGETS[0]);
+  for (size_t offset = 0; offset < bytes; offset += SELFCHECK_MESSAGE_SIZE)
+    selfChecking.CrcDefault(gRngBuf + offset, SELFCHECK_MESSAGE_SIZE, 0);
+  const bool detected = selfChecking.Failures() > 0 && selfChecking.Failures() == selfChecking.Checks();
+  tableBytes[sizeof(ProtectedGenericCrc) / 2] ^= 0x10;
+  const bool repaired = selfChecking.CheckNow();
+  correct = correct && detected && repaired;
+  std::cout << std::endl
+    << "  Verfaelschte Tabelle: " << selfChecking.Failures() << " von " << (selfChecking.Checks() - 1)
+    << " Pruefungen fehlgeschlagen, nach Reparatur " << (repaired? "intakt" : "weiterhin fehlerhaft")
+    << "  " << ((detected && repaired)? "OK" : "FEHLER") << std::endl;
+  return correct;
+}
+
+
+// CRC32C ueber ein Abbild, dessen Seiten zu ZERO_PERCENT[] Prozent aus
+// Nullen bestehen: Crc32cSSE4 liest alle Bytes, CrcExtents() bekommt die
+// Seiten mit Daten vorgegeben und rechnet die Nullen dazwischen nur ein
+static const size_t SPARSE_PAGE_SIZE = 4096;
+
+bool runSparseBenchmark(void) {
+  static const int ZERO_PERCENT[] = { 0, 50, 90, 99 };
+  const size_t numPages = (size_t)gMaxNumThreads * gRngBufSize / SPARSE_PAGE_SIZE;
+  const size_t bufSize = numPages * SPARSE_PAGE_SIZE;
+  uint8_t* image = new uint8_t[bufSize];
+  std::vector<crcutil::Crc32cSparse::Extent> extents;
+  crcutil::Crc32cSparse crcImpl(true);
+  bool correct = true;
+  std::cout << std::endl
+    << "CRC32C ueber ein Abbild aus " << (bufSize/1024/1024) << " MByte mit leeren Seiten zu " << SPARSE_PAGE_SIZE << " Bytes:" << std::endl
+    << std::endl
+    << "  Nullen  Crc32cSSE4         CrcExtents" << std::endl
+    << "  ---------------------------------------------------------" << std::endl;
+  for (size_t j = 0; j < sizeof(ZERO_PERCENT) / sizeof(ZERO_PERCENT[0]); ++j) {
+    // Seiten mit Daten zufaellig waehlen; benachbarte zu einem Extent zusammenfassen
+    memset(image, 0, bufSize);
+    extents.clear();
+    uint32_t x = 0x12345678U;
+    for (size_t k = 0; k < numPages; ++k) {
+      x = x * 1664525U + 1013904223U;
+      if ((int)((x >> 16) % 100) < ZERO_PERCENT[j])
+        continue;
+      const size_t offset = k * SPARSE_PAGE_SIZE;
+      memcpy(image + offset, gRngBuf + offset, SPARSE_PAGE_SIZE);
+      if (!extents.empty() && extents.back().offset + extents.back().bytes == offset) {
+        extents.back().bytes += SPARSE_PAGE_SIZE;
+      }
+      else {
+        const crcutil::Crc32cSparse::Extent extent = { offset, SPARSE_PAGE_SIZE };
+        extents.push_back(extent);
+      }
+    }
+    int64_t ticksMin[2] = { LLONG_MAX, LLONG_MAX };
+    uint32_t crc[2] = { 0, 0 };
+    bool ok = true;
+    for (int m = 0; m < 2; ++m) {
+      for (int i = 0; i < gIterations; ++i) {
+        int64_t t, ticks;
+        {
+          Stopwatch stopwatch(t, ticks);
+          switch (m) {
+          case 0:
+            crc[m] = (uint32_t)crcImpl.CrcDefault(image, bufSize, 0);
+            break;
+          case 1:
+            crc[m] = (uint32_t)crcImpl.CrcExtents(image, bufSize, extents.empty()? NULL : &extents[0], extents.size(), 0);
+            break;
+          }
+        }
+        if (ticks < ticksMin[m])
+          ticksMin[m] = ticks;
+      }
+      ok = ok && crc[m] == crc[0];
+    }
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(5) << ZERO_PERCENT[j] << "% "
+      << std::fixed << std::setprecision(2);
+    for (int m = 0; m < 2; ++m) {
+      std::cout << std::setw(6) << (double)ticksMin[m] / bufSize << " Zyklen/Byte";
+      if (m > 0)
+        std::cout << " (" << std::setprecision(1) << std::setw(5) << (double)ticksMin[0] / ticksMin[m] << "x)" << std::setprecision(2);
+      std::cout << "  ";
+    }
+    std::cout << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  delete [] image;
+  return correct;
+}
+
+
+// Nachrichten aus Kopf, Nutzdaten und Anhang ohne Kopieren (Crc32cGather)
+// gegen die zusammenhaengende Nachricht (Crc32cSSE4); Kopf und Anhang sind
+// oft nur 0 bis 7 Bytes lang, so dass Segmentgrenzen mitten in ein Wort fallen
+bool runGatherBenchmark(void) {
+  static const int GATHER_MESSAGE_SIZES[] = { 64, 256, 1500, 9000 };
+  // wie bei runBatchBenchmark() im L2-Cache bleiben und mehrfach wiederholen
+  static const size_t GATHER_BUFFER_SIZE = 256 * 1024;
+  static const int GATHER_REPETITIONS = 256;
+#if defined(_MSC_VER)
+  static const int NUM_GATHER_METHODS = 2;
+#else
+  static const int NUM_GATHER_METHODS = 3;
+#endif
+  const size_t bufSize = std::min((size_t)gMaxNumThreads * gRngBufSize, GATHER_BUFFER_SIZE);
+  std::vector<crcutil::Crc32cGather::Segment> segments;
+#if !defined(_MSC_VER)
+  std::vector<struct iovec> iov;
+#endif
+  std::vector<crcutil::Crc32cGather::Crc> crcs[NUM_GATHER_METHODS];
+  bool correct = true;
+  std::cout << std::endl
+    << "Nachrichten aus Kopf, Nutzdaten und Anhang zusammenhaengend (Crc32cSSE4)" << std::endl
+    << "und in Segmenten (Crc32cGather):" << std::endl
+    << std::endl
+    << "  Bytes    Crc32cSSE4       CrcGather(Segment)  CrcGather(iovec)" << std::endl
+    << "  --------------------------------------------------------------------" << std::endl;
+  for (size_t j = 0; j < sizeof(GATHER_MESSAGE_SIZES) / sizeof(GATHER_MESSAGE_SIZES[0]); ++j) {
+    const size_t msgSize = GATHER_MESSAGE_SIZES[j];
+    // jede Nachricht zufaellig in drei Segmente aufteilen
+    segments.clear();
+    uint32_t x = 0x9e3779b9U;
+    for (size_t offset = 0; offset + msgSize <= bufSize; offset += msgSize) {
+      x = x * 1664525U + 1013904223U;
+      size_t header = (x >> 8) % ((x & 0x80000000U)? 64 : 8);
+      if (header > msgSize)
+        header = msgSize;
+      size_t trailer = (x >> 16) % 8;
+      if (trailer > msgSize - header)
+        trailer = msgSize - header;
+      const crcutil::Crc32cGather::Segment segment[3] = {
+        { gRngBuf + offset, header },
+        { gRngBuf + offset + header, msgSize - header - trailer },
+        { gRngBuf + offset + msgSize - trailer, trailer }
+      };
+      segments.insert(segments.end(), segment, segment + 3);
+    }
+    const size_t numMessages = segments.size() / 3;
+#if !defined(_MSC_VER)
+    iov.resize(segments.size());
+    for (size_t k = 0; k < segments.size(); ++k) {
+      iov[k].iov_base = const_cast<void*>(segments[k].data);
+      iov[k].iov_len = segments[k].bytes;
+    }
+#endif
+    bool ok = true;
+    int64_t tMin[NUM_GATHER_METHODS];
+    for (int m = 0; m < NUM_GATHER_METHODS; ++m) {
+      crcs[m].resize(numMessages);
+      tMin[m] = LLONG_MAX;
+    }
+    for (int canonical = 0; canonical < 2; ++canonical) {
+      crcutil::Crc32cSSE4 crcImpl(canonical != 0);
+      crcutil::Crc32cGather gatherImpl(canonical != 0);
+      for (int m = 0; m < NUM_GATHER_METHODS; ++m) {
+        for (int i = 0; i < gIterations; ++i) {
+          int64_t t, ticks;
+          {
+            Stopwatch stopwatch(t, ticks);
+            for (int r = 0; r < GATHER_REPETITIONS; ++r) {
+              for (size_t k = 0; k < numMessages; ++k) {
+                switch (m) {
+                case 0:
+                  crcs[m][k] = crcImpl.CrcDefault(segments[3*k].data, msgSize, k);
+                  break;
+                case 1:
+                  crcs[m][k] = gatherImpl.CrcGather(&segments[3*k], 3, k);
+                  break;
+#if !defined(_MSC_VER)
+                case 2:
+                  crcs[m][k] = gatherImpl.CrcGather(&iov[3*k], 3, k);
+                  break;
+#endif
+                }
+              }
+            }
+          }
+          if (t < tMin[m])
+            tMin[m] = t;
+        }
+        ok = ok && crcs[m] == crcs[0];
+      }
+    }
+    correct = correct && ok;
+    std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+    std::cout << "  " << std::setfill(' ') << std::setw(5) << msgSize << "  "
+      << std::fixed << std::setprecision(2);
+    for (int m = 0; m < NUM_GATHER_METHODS; ++m) {
+      if (tMin[m] <= 0)
+        tMin[m] = 1;
+      const double s = (double)tMin[m] / Stopwatch::RESOLUTION / GATHER_REPETITIONS;
+      std::cout << std::setw(10) << (double)numMessages*msgSize/1024/1024/s << " MB/s  ";
+      if (m > 0)
+        std::cout << "    ";
+    }
+    std::cout << ((ok)? "OK" : "FEHLER") << std::endl;
+  }
+  return correct;
+}
+
+
+// PATCH_COUNT zufaellige Bereiche einer Nachricht aus PATCH_MESSAGE_SIZE
+// Bytes nacheinander ueberschreiben und den CRC jeweils mit
+// GfUtil::ReplaceBytes() und GfUtil::ApplyDelta() fortschreiben; beide
+// muessen nach jedem Patch den neu berechneten CRC der Nachricht liefern.
+// crcImpl ist das zu pruefende Verfahren, rawImpl dasselbe Polynom ohne
+// Startwert und Invertierung, mit dem der CRC der Differenz entsteht.
+static const size_t PATCH_MESSAGE_SIZE = 256 * 1024;
+static const int PATCH_COUNT = 1000;
+
+template <class CRCIMPL>
+bool runPatchCheck(const char* strName, const CRCIMPL& crcImpl, const CRCIMPL& rawImpl, uint8_t* msg, uint8_t* delta) {
+  typedef typename CRCIMPL::Crc Crc;
+  memcpy(msg, gRngBuf, PATCH_MESSAGE_SIZE);
+  Crc crc = crcImpl.CrcDefault(msg, PATCH_MESSAGE_SIZE, 0);
+  int replaceErrors = 0, deltaErrors = 0;
+  int64_t tPatch = 0, tFull = 0;
+  uint32_t x = 0x2545f491U;
+  for (int k = 0; k < PATCH_COUNT; ++k) {
+    // meist kurze Bereiche, ab und zu leere oder bis zu 4 KByte lange;
+    // auch ganz am Anfang und am Ende der Nachricht
+    x = x * 1664525U + 1013904223U;
+    size_t bytes = (x >> 8) % (((x & 0x7U) == 0)? 4097 : 65);
+    x = x * 1664525U + 1013904223U;
+    size_t offset = (x >> 4) % (PATCH_MESSAGE_SIZE - bytes + 1);
+    if ((k & 0xff) == 1)
+      offset = 0;
+    else if ((k & 0xff) == 2)
+      offset = PATCH_MESSAGE_SIZE - bytes;
+    const uint8_t* const newBytes = gRngBuf + PATCH_MESSAGE_SIZE + (x & 0xffffU);
+    for (size_t i = 0; i < bytes; ++i)
+      delta[i] = msg[offset + i] ^ newBytes[i];
+    const int64_t ticks0 = (int64_t)__rdtsc();
+    const Crc replaced = crcImpl.Base().ReplaceBytes(crc, PATCH_MESSAGE_SIZE, offset, msg + offset, newBytes, bytes);
+    const Crc deltaCrc = rawImpl.CrcDefault(delta, bytes, 0);
+    const Crc applied = crcImpl.Base().ApplyDelta(crc, deltaCrc, PATCH_MESSAGE_SIZE - offset - bytes);
+    const int64_t ticks1 = (int64_t)__rdtsc();
+    memcpy(msg + offset, newBytes, bytes);
+    crc = crcImpl.CrcDefault(msg, PATCH_MESSAGE_SIZE, 0);
+    const int64_t ticks2 = (int64_t)__rdtsc();
+    tPatch += ticks1 - ticks0;
+    tFull += ticks2 - ticks1;
+    if (replaced != crc)
+      ++replaceErrors;
+    if (applied != crc)
+      ++deltaErrors;
+  }
+  const bool ok = (replaceErrors == 0 && deltaErrors == 0);
+  std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+  std::cout << "  " << std::setfill(' ') << std::setw(24) << strName;
+  std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+  std::cout << std::setw(12) << replaceErrors << std::setw(12) << deltaErrors
+    << std::setw(15) << tPatch / PATCH_COUNT << std::setw(15) << tFull / PATCH_COUNT
+    << "  " << ((ok)? "OK" : "FEHLER") << std::endl;
+  return ok;
+}
+
+
+bool runPatchBenchmark(void) {
+  typedef crcutil::GenericCrc<crcutil::uint64, crcutil::uint64, crcutil::uint64, 4> GenericCrc64;
+  // die neuen Bytes stammen aus dem Bereich hinter der Nachricht
+  if ((size_t)gMaxNumThreads * gRngBufSize < PATCH_MESSAGE_SIZE + 0x10000 + 4096) {
+    std::cerr << "FEHLER: zu wenig Zufallszahlen fuer --patch!" << std::endl;
+    return false;
+  }
+  uint8_t* msg = new uint8_t[PATCH_MESSAGE_SIZE];
+  uint8_t* delta = new uint8_t[4096];
+  std::cout << std::endl
+    << PATCH_COUNT << " Bereiche einer Nachricht zu " << (PATCH_MESSAGE_SIZE/1024) << " KByte ueberschreiben und den CRC" << std::endl
+    << "fortschreiben (ReplaceBytes, ApplyDelta) statt neu berechnen:" << std::endl
+    << std::endl
+    << "  Fehler bzw. Zyklen je Patch:" << std::endl
+    << std::endl
+    << "  Verfahren               ReplaceBytes  ApplyDelta  fortschreiben  neu berechnen" << std::endl
+    << "  ------------------------------------------------------------------------------" << std::endl;
+  bool correct = true;
+  const crcutil::Crc32cSSE4 rawCrc32c(false);
+  const crcutil::Crc32cSSE4 canonicalCrc32c(true);
+  correct = runPatchCheck("Crc32cSSE4", rawCrc32c, rawCrc32c, msg, delta) && correct;
+  correct = runPatchCheck("Crc32cSSE4 (kanonisch)", canonicalCrc32c, rawCrc32c, msg, delta) && correct;
+  const GenericCrc64 rawCrc64(crcutil::Crc64Clmul::Ecma182Polynomial(), 64, false);
+  const GenericCrc64 canonicalCrc64(crcutil::Crc64Clmul::Ecma182Polynomial(), 64, true);
+  correct = runPatchCheck("CRC64 (GenericCrc)", rawCrc64, rawCrc64, msg, delta) && correct;
+  correct = runPatchCheck("CRC64 (kanonisch)", canonicalCrc64, rawCrc64, msg, delta) && correct;
+  delete [] msg;
+  delete [] delta;
+  return correct;
+}
+
+
+// Zeitstempel vor und nach einem gemessenen Aufruf: CPUID verhindert, dass
+// Befehle vor bzw. nach der Messung in den gemessenen Bereich wandern;
+// RDTSCP wartet, bis alle vorangehenden Befehle abgeschlossen sind
+static inline int64_t latencyStart(void) {
+#if defined(WIN32)
+  int regs[4];
+  __cpuid(regs, 0);
+  return (int64_t)__rdtsc();
+#elif defined(__GNUC__)
+  return (int64_t)__rdtsc();
+#endif
+}
+
+static inline int64_t latencyStop(void) {
+#if defined(WIN32)
+  unsigned int aux;
+  const int64_t ticks = (int64_t)__rdtscp(&aux);
+  int regs[4];
+  __cpuid(regs, 0);
+  return ticks;
+#elif defined(__GNUC__)
+  return (int64_t)__rdtscp();
+#endif
+}
+
+
+// Taktfrequenz des Time Stamp Counter in Hz, gemessen ueber 200 ms
+static double tscFrequency(void) {
+  int64_t t, ticks;
+  Stopwatch stopwatch(t, ticks);
+  do {
+    stopwatch.stop();
+  }
+  while (t < Stopwatch::RESOLUTION / 5);
+  return (double)ticks * Stopwatch::RESOLUTION / t;
+}
+
+
+// Perzentil P (0 < P <= 1) der aufsteigend sortierten Werte (nearest rank)
+static int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+  size_t rank = (size_t)(p * sorted.size() + 0.999999);
+  if (rank < 1)
+    rank = 1;
+  if (rank > sorted.size())
+    rank = sorted.size();
+  return sorted[rank - 1];
+}
+
+
+// Dauer jedes einzelnen Aufrufs der CRC32C-Kerne fuer Nachrichten zu
+// gLatencySizes[] Bytes in Taktzyklen messen und daraus Perzentile und
+// Durchsatz berechnen; die Nachrichten liegen hintereinander in den
+// Bloecken, so dass lange Nachrichten auch aus dem Speicher kommen
+void runLatencyBenchmark(void) {
+  static const double PERCENTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+  static const int NUM_PERCENTILES = sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+  const size_t bufSize = (size_t)gMaxNumThreads * gRngBufSize;
+  const double hz = tscFrequency();
+  const Crc32cDispatcher& dispatcher = Crc32cDispatcher::instance();
+
+  // Kosten der Messung selbst (Minimum ueber viele leere Messungen)
+  int64_t overhead = LLONG_MAX;
+  for (int i = 0; i < 10000; ++i) {
+    const int64_t ticks0 = latencyStart();
+    const int64_t ticks = latencyStop() - ticks0;
+    if (ticks < overhead)
+      overhead = ticks;
+  }
+
+  std::cout << std::endl
+    << "Latenz einzelner CRC32C-Aufrufe (TSC mit " << std::fixed << std::setprecision(2) << hz / 1e9
+    << " GHz, Messaufwand von " << overhead << " Zyklen abgezogen)," << std::endl
+    << "Angaben in Zyklen und Nanosekunden:" << std::endl
+    << std::endl
+    << "  Groesse  Methode              p50         p90         p99       p99.9      Durchsatz" << std::endl
+    << "  ------------------------------------------------------------------------------------------" << std::endl;
+  std::vector<int64_t> samples;
+  for (size_t j = 0; j < gLatencySizes.size(); ++j) {
+    const size_t size = (gLatencySizes[j] < bufSize)? gLatencySizes[j] : bufSize;
+    // etwa 64 MByte pro Kern, aber mindestens 1000 und hoechstens 100000 Aufrufe
+    size_t numSamples = (64 * 1024 * 1024) / size;
+    if (numSamples < 1000)
+      numSamples = 1000;
+    if (numSamples > 100000)
+      numSamples = 100000;
+    samples.resize(numSamples);
+    for (int k = 0; k <= Crc32cDispatcher::NUM_KERNELS; ++k) {
+      // k == NUM_KERNELS steht fuer den Dispatcher
+      const bool isDispatcher = (k == Crc32cDispatcher::NUM_KERNELS);
+      if (!isDispatcher && !Crc32cDispatcher::isAvailable((Crc32cDispatcher::Kernel)k))
+        continue;
+      const Crc32cFunction crc32c = isDispatcher? dispatcher.function() : Crc32cDispatcher::kernelFunction((Crc32cDispatcher::Kernel)k);
+      volatile uint32_t sink = 0;
+      size_t offset = 0;
+      int64_t sum = 0;
+      for (size_t i = 0; i < numSamples; ++i) {
+        if (offset + size > bufSize)
+          offset = 0;
+        const int64_t ticks0 = latencyStart();
+        const uint32_t crc = crc32c(gRngBuf + offset, size, 0);
+        const int64_t ticks = latencyStop() - ticks0 - overhead;
+        sink ^= crc;
+        samples[i] = (ticks > 0)? ticks : 0;
+        sum += samples[i];
+        offset += size;
+      }
+      std::sort(samples.begin(), samples.end());
+      std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+      std::cout << "  " << std::setfill(' ') << std::setw(9);
+      if (k == 0)
+        std::cout << size;
+      else
+        std::cout << "";
+      std::cout << std::setw(17) << (isDispatcher? "Crc32cDispatcher" : Crc32cDispatcher::kernelName((Crc32cDispatcher::Kernel)k));
+      std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+      for (int p = 0; p < NUM_PERCENTILES; ++p)
+        std::cout << std::setw(12) << percentile(samples, PERCENTILES[p]);
+      std::cout << std::setw(11) << std::setprecision(2)
+        << (double)size * numSamples / 1024 / 1024 / ((double)(sum > 0? sum : 1) / hz) << " MB/s" << std::endl;
+      std::cout << std::setw(28) << "";
+      for (int p = 0; p < NUM_PERCENTILES; ++p)
+        std::cout << std::setw(9) << std::setprecision(0) << 1e9 * percentile(samples, PERCENTILES[p]) / hz << " ns";
+      std::cout << std::endl;
+    }
+  }
+}
+
+
+void printFileResult(const char* strMethod, bool ok, bool withCrc, uint32_t crc, int64_t t, uint64_t bytes, int64_t tRead) {
+  std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+  std::cout << "  " << std::setfill(' ') << std::setw(18) << strMethod << "  ";
+  std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+  if (!ok) {
+    std::cout << "FEHLER beim Lesen der Datei!" << std::endl;
+    return;
+  }
+  if (withCrc)
+    std::cout << "0x" << std::setfill('0') << std::hex << std::setw(8) << crc << std::setfill(' ') << std::dec;
+  else
+    std::cout << std::setw(10) << "-";
+  if (t <= 0)
+    t = 1;
+  std::cout << std::setw(10) << (1000*t/Stopwatch::RESOLUTION) << " ms  "
+    << std::fixed << std::setprecision(2) << std::setw(8)
+    << (double)bytes/1024/1024/1024/((double)t/Stopwatch::RESOLUTION) << " GB/s"
+    << std::setw(8) << std::setprecision(0) << 100.0 * tRead / t << " %"
+    << std::endl;
+}
+
+
+// CRC32C einer Datei mit den Verfahren aus filecrc.h berechnen
+template <class CRCIMPL>
+bool runFileBenchmark(const CRCIMPL& crcImpl, const char* strKernel) {
+  FileCrc<CRCIMPL> file(crcImpl);
+  if (!file.open(gFilename)) {
+    std::cerr << "FEHLER: Datei '" << gFilename << "' kann nicht geoeffnet werden!" << std::endl;
+    return false;
+  }
+  const uint64_t bytes = file.size();
+  std::cout << "Bilden der Pruefsumme von '" << gFilename << "' (" << (bytes/1024/1024) << " MByte) mit " << strKernel << " ..." << std::endl
+    << std::endl
+    << "  Verfahren           CRC             Zeit      Durchsatz  rel. zu read" << std::endl
+    << "  --------------------------------------------------------------------" << std::endl;
+  int64_t tRead, tPread, tMmap, ticks;
+  bool readOk, preadOk, mmapOk;
+  // jeder Durchgang liest die Datei vom Datentraeger, nicht aus dem Cache
+  bool cacheDropped = file.dropCache();
+  {
+    Stopwatch stopwatch(tRead, ticks);
+    readOk = file.read();
+  }
+  if (tRead <= 0)
+    tRead = 1;
+  printFileResult("read", readOk, false, 0, tRead, bytes, tRead);
+  typename CRCIMPL::Crc preadCrc = 0, mmapCrc = 0;
+  cacheDropped = file.dropCache() && cacheDropped;
+  {
+    Stopwatch stopwatch(tPread, ticks);
+    preadOk = file.readCrc(preadCrc, 0);
+  }
+  printFileResult("read + CRC", preadOk, true, (uint32_t)preadCrc, tPread, bytes, tRead);
+  // im 32-Bit-Build passen Dateien ab 4 GByte nicht in den Adressraum
+  if (file.mappable()) {
+    cacheDropped = file.dropCache() && cacheDropped;
+    {
+      Stopwatch stopwatch(tMmap, ticks);
+      mmapOk = file.mapCrc(mmapCrc, 0);
+    }
+    printFileResult("mmap + CRC", mmapOk, true, (uint32_t)mmapCrc, tMmap, bytes, tRead);
+  }
+  else {
+    std::cout << "  mmap + CRC          (Datei zu gross fuer den Adressraum)" << std::endl;
+    mmapOk = true;
+    mmapCrc = preadCrc;
+  }
+  if (!cacheDropped)
+    std::cout << std::endl << "  (Dateicache konnte nicht geleert werden, Zeiten sind ggf. nicht vergleichbar)" << std::endl;
+  const bool correct = readOk && preadOk && mmapOk && preadCrc == mmapCrc;
+  if (gVerbose > 0) {
+    std::cout << std::endl;
+    if (correct)
+      std::cout << "OK." << std::endl;
+    else 
+      std::cerr << "FEHLER: unterschiedliche CRC-Ergebnisse!" << std::endl;
+  }
+  return correct;
+}
+
+
+// alle verfuegbaren Methoden nacheinander messen
+void runAllBenchmarks(int numThreads) {
+  if (CPUFeatures::instance().isCRCSupported()) {
+    runBenchmark(numThreads, "_mm_crc32_u8", Intrinsic8);
+    runBenchmark(numThreads, "_mm_crc32_u16", Intrinsic16);
+    runBenchmark(numThreads, "_mm_crc32_u32", Intrinsic32);
+#if defined(_M_X64) || defined(__x86_64__)
+    runBenchmark(numThreads, "_mm_crc32_u64", Intrinsic64);
+    runBenchmark(numThreads, "_mm_crc32_u64 x3", Intrinsic64x3);
+#endif
+  }
+  runBenchmark(numThreads, "boost::crc", Boost);
+  runBenchmark(numThreads, "naive", DefaultNaive);
+  runBenchmark(numThreads, "optimized", DefaultOptimized);
+  runBenchmark(numThreads, "slicing-by-8", SlicingBy8);
+  runBenchmark(numThreads, "slicing-by-16", SlicingBy16);
+  if (CPUFeatures::instance().isCRCSupported() && CPUFeatures::instance().isClmulSupported())
+    runBenchmark(numThreads, "CRC32Clmul", DefaultClmul);
+  if (Crc32cDispatcher::isAvailable(Crc32cDispatcher::KERNEL_SSE4))
+    runBenchmark(numThreads, "Crc32cSSE4", Crc32cSSE4);
+  if (Crc32cDispatcher::isAvailable(Crc32cDispatcher::KERNEL_CLMUL))
+    runBenchmark(numThreads, "Crc32cClmul", Crc32cClmul);
+  if (Crc32cDispatcher::isAvailable(Crc32cDispatcher::KERNEL_CLMUL512))
+    runBenchmark(numThreads, "Crc32cClmul/512", Crc32cAvx512);
+  // nicht erst in den Benchmark-Threads kalibrieren, s. Crc32cDispatcher
+  Crc32cDispatcher::init();
+  runBenchmark(numThreads, "Crc32cDispatcher", Dispatched);
+}
+
+
+// Ergebnisse aller Methoden miteinander vergleichen
+bool checkResults(void) {
+  bool correct = true;
+  if (gCrcResults.empty())
+    return correct;
+  if (gVerbose > 1) 
+    std::cout << std::endl;
+  const uint32_t crc = gCrcResults.begin()->crc;
+  for (std::vector<CrcResult>::const_iterator i = gCrcResults.begin(); i != gCrcResults.end() && correct; ++i) {
+    correct = (i->crc == crc);
+    if (gVerbose > 1)
+      std::cout << "Pruefen des Ergebnisses von Methode '" << i->method
+      << "' in " << i->nThreads << " Threads ..."
+      << ((correct)? "OK" : "FEHLER") << std::endl;
+  }
+  gCrcResults.clear();
+  return correct;
+}
+
+
+// Software-Implementierungen mit kleinen Nachrichten vergleichen;
+// die Hardware-Implementierungen dienen als Referenz
+bool runSmallMessageBenchmarks(void) {
+  static const int SMALL_MESSAGE_SIZES[] = { 64, 256, 1024, 4096 };
+  bool correct = true;
+  for (size_t j = 0; j < sizeof(SMALL_MESSAGE_SIZES) / sizeof(SMALL_MESSAGE_SIZES[0]); ++j) {
+    gMessageSize = SMALL_MESSAGE_SIZES[j];
+    for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 ; ++i) {
+      const int numThreads = gNumThreads[i];
+      std::cout << std::endl
+        << "... Nachrichten zu " << gMessageSize << " Bytes in " << numThreads << " Thread" << (numThreads == 1? "" : "s") << ":" << std::endl
+        << std::endl
+        << "  Methode             CRC             t/Block      Durchsatz  Zyklen" << std::endl
+        << "  ------------------------------------------------------------------" << std::endl;
+      runBenchmark(numThreads, "naive", DefaultNaive);
+      runBenchmark(numThreads, "optimized", DefaultOptimized);
+      runBenchmark(numThreads, "slicing-by-8", SlicingBy8);
+      runBenchmark(numThreads, "slicing-by-16", SlicingBy16);
+      runBenchmark(numThreads, "boost::crc", Boost);
+      if (CPUFeatures::instance().isCRCSupported()) {
+#if defined(_M_X64) || defined(__x86_64__)
+        runBenchmark(numThreads, "_mm_crc32_u64", Intrinsic64);
+#else
+        runBenchmark(numThreads, "_mm_crc32_u32", Intrinsic32);
+#endif
+      }
+    }
+    correct = checkResults() && correct;
+  }
+  return correct;
+}
+
+
 void usage(void) {
   std::cout << "Aufruf: crc [Optionen]" << std::endl
     << std::endl
@@ -369,6 +1678,78 @@ void usage(void) {
     << "     Zufallszahlen in N Threads parallel generieren (Vorgabe: " << DEFAULT_NUM_THREADS << ")" << std::endl
     << "     Mehrfachnennungen mglich." << std::endl
     << std::endl
+    << "  (--message-size|-m) N" << std::endl
+    << "     Die Bloecke in Nachrichten zu N Bytes (Vielfaches von 8) zerlegen" << std::endl
+    << "     und fuer jede Nachricht ein neues CRC-Objekt erzeugen" << std::endl
+    << std::endl
+    << "  --small" << std::endl
+    << "     Die Software-Implementierungen mit kleinen Nachrichten" << std::endl
+    << "     (64, 256, 1024 und 4096 Bytes) vergleichen" << std::endl
+    << std::endl
+    << "  --batch" << std::endl
+    << "     Viele kleine Nachrichten (64 bis 1024 Bytes) einzeln mit Crc32cSSE4" << std::endl
+    << "     und gebuendelt mit Crc32cBatch pruefen und Nachrichten/s vergleichen" << std::endl
+    << std::endl
+    << "  --copy" << std::endl
+    << "     Kopieren mit anschliessendem CRC (memcpy + Crc32cSSE4) mit dem" << std::endl
+    << "     kombinierten Kopieren und Pruefen (Crc32cCopy) vergleichen," << std::endl
+    << "     mit und ohne Non-temporal Stores" << std::endl
+    << std::endl
+    << "  --chunks" << std::endl
+    << "     Die Bloecke (bzw. mit --file die Datei) anhand eines rollenden CRC" << std::endl
+    << "     ueber " << CHUNK_WINDOW_SIZE << " Bytes in Abschnitte variabler Laenge zerlegen" << std::endl
+    << "     (content-defined chunking), verteilt auf die mit -t angegebene" << std::endl
+    << "     Anzahl Threads" << std::endl
+    << std::endl
+    << "  --rolling" << std::endl
+    << "     Rollenden CRC ueber " << CHUNK_WINDOW_SIZE << " Bytes an jeder Position der Bloecke bilden" << std::endl
+    << "     und moegliche Chunk-Grenzen suchen: Roll() gegen AVX2 mit 32 Fenstern" << std::endl
+    << std::endl
+    << "  --crc64" << std::endl
+    << "     CRC64 nach ECMA-182 und NVMe ueber die Bloecke bilden: tabellen-" << std::endl
+    << "     gesteuert (GenericCrc) gegen PCLMULQDQ (Crc64Clmul)" << std::endl
+    << std::endl
+    << "  --polynomials" << std::endl
+    << "     CRC-16/ARC, CRC-32 (IEEE), CRC-32C und CRC-64/XZ ueber die Bloecke" << std::endl
+    << "     bilden: GenericCrc gegen PCLMULQDQ mit zur Laufzeit (Crc64Clmul)" << std::endl
+    << "     und beim Kompilieren (CRCClmul<>) berechneten Konstanten" << std::endl
+    << std::endl
+    << "  --selfcheck" << std::endl
+    << "     CRC32C ueber die Bloecke in Nachrichten zu " << SELFCHECK_MESSAGE_SIZE << " Bytes bilden und" << std::endl
+    << "     die Tabellen dabei automatisch in kleinen Portionen pruefen" << std::endl
+    << "     (SelfCheckingCrc); anschliessend eine verfaelschte Tabelle erkennen" << std::endl
+    << std::endl
+    << "  --sparse" << std::endl
+    << "     CRC32C ueber ein Abbild aus den Bloecken bilden, dessen Seiten zu" << std::endl
+    << "     0 bis 99 Prozent leer sind: alle Bytes (Crc32cSSE4) gegen das" << std::endl
+    << "     Ueberspringen vorgegebener Nullen (CrcExtents)" << std::endl
+    << std::endl
+    << "  --gather" << std::endl
+    << "     CRC32C ueber Nachrichten bilden, die in Kopf, Nutzdaten und Anhang" << std::endl
+    << "     zerlegt sind (Crc32cGather mit Segment und iovec), und mit dem" << std::endl
+    << "     CRC der zusammenhaengenden Nachricht (Crc32cSSE4) vergleichen" << std::endl
+    << std::endl
+    << "  --patch" << std::endl
+    << "     Bereiche einer Nachricht ueberschreiben und den CRC32C bzw. CRC64" << std::endl
+    << "     mit ReplaceBytes() und ApplyDelta() fortschreiben; nach jedem" << std::endl
+    << "     Patch mit dem neu berechneten CRC vergleichen" << std::endl
+    << std::endl
+    << "  --latency N" << std::endl
+    << "     Die Dauer jedes einzelnen CRC32C-Aufrufs fuer Nachrichten zu N Bytes" << std::endl
+    << "     in Taktzyklen (RDTSCP) messen und die Perzentile p50, p90, p99 und" << std::endl
+    << "     p99.9 in Zyklen und Nanosekunden sowie den Durchsatz ausgeben." << std::endl
+    << "     Mehrfachnennungen moeglich." << std::endl
+    << std::endl
+    << "  (--parallel|-p)" << std::endl
+    << "     Zusaetzlich den CRC ueber alle Bloecke in einem Stueck berechnen," << std::endl
+    << "     verteilt auf die mit -t angegebene Anzahl Threads" << std::endl
+    << std::endl
+    << "  (--file|-f) DATEI" << std::endl
+    << "     CRC32C (Startwert 0xffffffff) der Datei DATEI mit dem schnellsten" << std::endl
+    << "     verfuegbaren Verfahren berechnen und mit der Lesebandbreite" << std::endl
+    << "     vergleichen; der Zufallszahlen-Benchmark entfaellt. Vor jedem" << std::endl
+    << "     Durchgang wird die Datei aus dem Dateicache entfernt" << std::endl
+    << std::endl
     << "  (--help|-h|-?)" << std::endl
     << "     Diese Hilfe anzeigen" << std::endl
     << std::endl;
@@ -396,7 +1777,7 @@ int main(int argc, char* argv[]) {
 #endif
   for (;;) {
     int option_index = 0;
-    int c = getopt_long(argc, argv, "vh?n:t:i:b:s:", long_options, &option_index);
+    int c = getopt_long(argc, argv, "vh?pn:t:i:b:s:f:m:", long_options, &option_index);
     if (c == -1)
       break;
     switch (c)
@@ -451,6 +1832,72 @@ int main(int argc, char* argv[]) {
     case 'v':
       ++gVerbose;
       break;
+    case SELECT_MESSAGE_SIZE:
+      // fall-through
+    case 'm':
+      if (optarg == NULL) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      gMessageSize = atoi(optarg) & ~7;
+      if (gMessageSize <= 0)
+        gMessageSize = 8;
+      break;
+    case SELECT_SMALL:
+      gSmallMessages = true;
+      break;
+    case SELECT_BATCH:
+      gBatch = true;
+      break;
+    case SELECT_COPY:
+      gCopy = true;
+      break;
+    case SELECT_CHUNKS:
+      gChunks = true;
+      break;
+    case SELECT_ROLLING:
+      gRolling = true;
+      break;
+    case SELECT_CRC64:
+      gCrc64 = true;
+      break;
+    case SELECT_POLYNOMIALS:
+      gPolynomials = true;
+      break;
+    case SELECT_SELFCHECK:
+      gSelfCheck = true;
+      break;
+    case SELECT_SPARSE:
+      gSparse = true;
+      break;
+    case SELECT_GATHER:
+      gGather = true;
+      break;
+    case SELECT_PATCH:
+      gPatch = true;
+      break;
+    case SELECT_LATENCY:
+      if (optarg == NULL) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      if (atoi(optarg) > 0)
+        gLatencySizes.push_back((size_t)atoi(optarg));
+      break;
+    case SELECT_FILE:
+      // fall-through
+    case 'f':
+      if (optarg == NULL) {
+        usage();
+        return EXIT_FAILURE;
+      }
+      gFilename = optarg;
+      break;
+    case SELECT_PARALLEL:
+      // fall-through
+    case 'p':
+      gParallel = true;
+      break;
     case 'h':
       // fall-through
     case '?':
@@ -555,6 +2002,10 @@ int main(int argc, char* argv[]) {
       << B[CPUFeatures::instance().f16c_supported] << std::endl
       << ">>> AVX              : " 
       << B[CPUFeatures::instance().avx_supported] << std::endl
+      << ">>> AVX2             : " 
+      << B[CPUFeatures::instance().isAVX2Supported()] << std::endl
+      << ">>> AVX-512F         : " 
+      << B[CPUFeatures::instance().isAVX512Supported()] << std::endl
       << ">>> FMA              : " 
       << B[CPUFeatures::instance().fma_supported] << std::endl
       << ">>> POPCNT           : " 
@@ -563,6 +2014,32 @@ int main(int argc, char* argv[]) {
       << B[CPUFeatures::instance().rdrand_supported] << std::endl
       << ">>> AES              : " 
       << B[CPUFeatures::instance().aes_supported] << std::endl
+      << ">>> PCLMULQDQ        : " 
+      << B[CPUFeatures::instance().isClmulSupported()] << std::endl
+      << ">>> VPCLMULQDQ       : " 
+      << B[CPUFeatures::instance().isVPCLMULQDQSupported()] << std::endl
+      << std::endl;
+
+    // Ergebnis der Kalibrierung von Crc32cDispatcher
+    const Crc32cDispatcher& dispatcher = Crc32cDispatcher::instance();
+    std::cout << ">>> CRC32C (Zyklen/Byte)";
+    for (int j = 0; j < Crc32cDispatcher::NUM_CALIBRATION_SIZES; ++j)
+      std::cout << std::setw(8) << Crc32cDispatcher::CALIBRATION_SIZES[j];
+    std::cout << std::endl;
+    for (int k = 0; k < Crc32cDispatcher::NUM_KERNELS; ++k) {
+      if (!Crc32cDispatcher::isAvailable((Crc32cDispatcher::Kernel)k))
+        continue;
+      std::cout.setf(std::ios_base::left, std::ios_base::adjustfield);
+      std::cout << ">>>   " << std::setw(17) << Crc32cDispatcher::kernelName((Crc32cDispatcher::Kernel)k);
+      std::cout.setf(std::ios_base::right, std::ios_base::adjustfield);
+      for (int j = 0; j < Crc32cDispatcher::NUM_CALIBRATION_SIZES; ++j)
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << dispatcher.cyclesPerByte((Crc32cDispatcher::Kernel)k, j);
+      std::cout << std::endl;
+    }
+    std::cout << ">>> CRC32C-Kern     : " << Crc32cDispatcher::kernelName(dispatcher.smallKernel());
+    if (dispatcher.smallKernel() != dispatcher.largeKernel())
+      std::cout << ", ab " << dispatcher.threshold() << " Bytes " << Crc32cDispatcher::kernelName(dispatcher.largeKernel());
+    std::cout << std::endl
       << std::endl;
 
     /*
@@ -593,6 +2070,25 @@ int main(int argc, char* argv[]) {
       << "//////////////////////////////////////////////////////" << std::endl;
   }
 
+  if (gFilename != NULL && gChunks) {
+    crcutil::Crc32cSSE4 crcImpl(false);
+    FileCrc<crcutil::Crc32cSSE4> file(crcImpl);
+    const uint8_t* data = NULL;
+    if (!file.open(gFilename) || (data = file.map()) == NULL) {
+      std::cerr << "FEHLER: Datei '" << gFilename << "' kann nicht eingeblendet werden!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Datei '" << gFilename << "':" << std::endl;
+    const bool ok = runChunkBenchmark(data, (size_t)file.size());
+    return (ok)? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (gFilename != NULL) {
+    const Crc32cDispatcher& dispatcher = Crc32cDispatcher::instance();
+    const bool ok = runFileBenchmark(dispatcher, Crc32cDispatcher::kernelName(dispatcher.largeKernel()));
+    return (ok)? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   // Speicherblcke mit Zufallszahlen belegen
   MersenneTwister gen;
   gen.seed();
@@ -618,40 +2114,70 @@ int main(int argc, char* argv[]) {
 #if defined(WIN32)
   SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 #endif
-  std::cout << "Bilden der Pruefsummen (" << gIterations << "x" << (gRngBufSize/1024/1024) << " MByte) ..." << std::endl;
-  for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 ; ++i) {
+  std::cout << "Bilden der Pruefsummen (" << gIterations << "x" << (gRngBufSize/1024/1024) << " MByte";
+  if (gMessageSize > 0)
+    std::cout << " in Nachrichten zu " << gMessageSize << " Bytes";
+  std::cout << ") ..." << std::endl;
+  bool smallCorrect = true;
+  if (gSmallMessages)
+    smallCorrect = runSmallMessageBenchmarks();
+  bool batchCorrect = true;
+  if (gBatch)
+    batchCorrect = runBatchBenchmark();
+  bool copyCorrect = true;
+  if (gCopy)
+    copyCorrect = runCopyBenchmark();
+  bool chunksCorrect = true;
+  if (gChunks)
+    chunksCorrect = runChunkBenchmark(gRngBuf, (size_t)gMaxNumThreads * gRngBufSize);
+  bool rollingCorrect = true;
+  if (gRolling)
+    rollingCorrect = runRollingBenchmark();
+  bool crc64Correct = true;
+  if (gCrc64)
+    crc64Correct = runCrc64Benchmark();
+  bool polynomialsCorrect = true;
+  if (gPolynomials)
+    polynomialsCorrect = runPolynomialBenchmarks();
+  bool selfCheckCorrect = true;
+  if (gSelfCheck)
+    selfCheckCorrect = runSelfCheckBenchmark();
+  bool sparseCorrect = true;
+  if (gSparse)
+    sparseCorrect = runSparseBenchmark();
+  bool gatherCorrect = true;
+  if (gGather)
+    gatherCorrect = runGatherBenchmark();
+  bool patchCorrect = true;
+  if (gPatch)
+    patchCorrect = runPatchBenchmark();
+  if (!gLatencySizes.empty())
+    runLatencyBenchmark();
+  for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 && !gSmallMessages && !gBatch && !gCopy && !gChunks && !gRolling && !gCrc64 && !gPolynomials && !gSelfCheck && !gSparse && !gGather && !gPatch && gLatencySizes.empty(); ++i) {
     const int numThreads = gNumThreads[i];
     std::cout << std::endl
       << "... in " << numThreads << " Thread" << (numThreads == 1? "" : "s") << ":" << std::endl
       << std::endl
       << "  Methode             CRC             t/Block      Durchsatz  Zyklen" << std::endl
       << "  ------------------------------------------------------------------" << std::endl;
-    if (CPUFeatures::instance().isCRCSupported()) {
-      runBenchmark(numThreads, "_mm_crc32_u8", Intrinsic8);
-      runBenchmark(numThreads, "_mm_crc32_u16", Intrinsic16);
-      runBenchmark(numThreads, "_mm_crc32_u32", Intrinsic32);
-#if defined(_M_X64) || defined(__x86_64__)
-      runBenchmark(numThreads, "_mm_crc32_u64", Intrinsic64);
-#endif
-    }
-    runBenchmark(numThreads, "boost::crc", Boost);
-    runBenchmark(numThreads, "naive", DefaultNaive);
-    runBenchmark(numThreads, "optimized", DefaultOptimized);
-    runBenchmark(numThreads, "Crc32cSSE4", Crc32cSSE4);
+    runAllBenchmarks(numThreads);
   }
 
-  if (gVerbose > 1) 
-    std::cout << std::endl;
-  bool correct = true;
-  const uint32_t crc = gCrcResults.begin()->crc;
-  for (std::vector<CrcResult>::const_iterator i = gCrcResults.begin(); i != gCrcResults.end() && correct; ++i) {
-    correct = (i->crc == crc);
-    if (gVerbose > 1)
-      std::cout << "Pruefen des Ergebnisses von Methode '" << i->method
-      << "' in " << i->nThreads << " Threads ..."
-      << ((correct)? "OK" : "FEHLER") << std::endl;
+  bool parallelCorrect = true;
+  if (gParallel) {
+    crcutil::Crc32cSSE4 crcImpl(false);
+    const uint32_t serialCrc = (uint32_t)crcImpl.CrcDefault(gRngBuf, (size_t)gMaxNumThreads * gRngBufSize, 0U);
+    std::cout << std::endl
+      << "CRC ueber " << gMaxNumThreads << "x" << (gRngBufSize/1024/1024) << " MByte in einem Stueck (Crc32cSSE4):" << std::endl
+      << std::endl
+      << "  Threads  CRC             t/Block      Durchsatz" << std::endl
+      << "  -----------------------------------------------" << std::endl;
+    for (int i = 0; i <= gThreadIterations && gNumThreads[i] > 0 ; ++i)
+      parallelCorrect = runParallelBenchmark(gNumThreads[i], crcImpl, serialCrc) && parallelCorrect;
   }
 
+  const bool correct = checkResults() && parallelCorrect && smallCorrect && batchCorrect && copyCorrect && chunksCorrect && rollingCorrect && crc64Correct && polynomialsCorrect && selfCheckCorrect && sparseCorrect && gatherCorrect && patchCorrect;
+
   if (gVerbose > 0) {
     std::cout << std::endl;
     if (correct)
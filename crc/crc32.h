@@ -10,13 +10,129 @@
 #include <stdint.h>
 #endif
 
+// Die folgenden Templates berechnen die CRC-Tabellen bereits beim
+// Kompilieren. Da Visual C++ 2012 noch kein constexpr kennt, geschieht
+// das per Template-Metaprogrammierung: Jeder Tabelleneintrag ist eine
+// statische Konstante eines eigenen Templates.
+
+// Bitreihenfolge eines 32-Bit-Werts umkehren
+template<uint32_t X>
+struct CRC32ReverseBits {
+  static const uint32_t a = ((X & 0xaaaaaaaaU) >> 1) | ((X & 0x55555555U) << 1);
+  static const uint32_t b = ((a & 0xccccccccU) >> 2) | ((a & 0x33333333U) << 2);
+  static const uint32_t c = ((b & 0xf0f0f0f0U) >> 4) | ((b & 0x0f0f0f0fU) << 4);
+  static const uint32_t d = ((c & 0xff00ff00U) >> 8) | ((c & 0x00ff00ffU) << 8);
+  static const uint32_t value = (d >> 16) | (d << 16);
+};
+
+
+// CRC eines Bytes: ROUNDS Schiebeschritte mit Polynom POLY
+template<uint32_t POLY, uint32_t BITS, int ROUNDS>
+struct CRC32TableBits {
+  static const uint32_t value =
+    CRC32TableBits<POLY, (BITS & 1U)? ((BITS >> 1) ^ POLY) : (BITS >> 1), ROUNDS - 1>::value;
+};
+
+template<uint32_t POLY, uint32_t BITS>
+struct CRC32TableBits<POLY, BITS, 0> {
+  static const uint32_t value = BITS;
+};
+
+
+// Eintrag I der Tabelle K: CRC des Bytes I, gefolgt von K Null-Bytes
+template<uint32_t POLY, int K, uint32_t I>
+struct CRC32TableEntry {
+  static const uint32_t prev = CRC32TableEntry<POLY, K - 1, I>::value;
+  static const uint32_t value = (prev >> 8) ^ CRC32TableEntry<POLY, 0, (prev & 0xffU)>::value;
+};
+
+template<uint32_t POLY, uint32_t I>
+struct CRC32TableEntry<POLY, 0, I> {
+  static const uint32_t value = CRC32TableBits<POLY, I, 8>::value;
+};
+
+
+// Anzahl der Tabellen, die fr Slicing-by-N maximal bentigt werden
+static const int CRC32_MAX_SLICES = 16;
+
+// Tabellen fr das Polynom POLY (bereits in der verwendeten
+// Bitreihenfolge); alle CRC32-Klassen mit demselben Polynom teilen
+// sich eine Instanz. Tabelle 0 ist die klassische 256-Eintrag-Tabelle.
+template<uint32_t POLY>
+struct CRC32Tables {
+  static const uint32_t tab[CRC32_MAX_SLICES][256];
+};
+
+#define CRC32_TABLE_ENTRY(k, i) CRC32TableEntry<POLY, k, (i)>::value
+#define CRC32_TABLE_ENTRIES_4(k, i) \
+  CRC32_TABLE_ENTRY(k, i), CRC32_TABLE_ENTRY(k, i + 1), \
+  CRC32_TABLE_ENTRY(k, i + 2), CRC32_TABLE_ENTRY(k, i + 3)
+#define CRC32_TABLE_ENTRIES_16(k, i) \
+  CRC32_TABLE_ENTRIES_4(k, i), CRC32_TABLE_ENTRIES_4(k, i + 4), \
+  CRC32_TABLE_ENTRIES_4(k, i + 8), CRC32_TABLE_ENTRIES_4(k, i + 12)
+#define CRC32_TABLE_ENTRIES_64(k, i) \
+  CRC32_TABLE_ENTRIES_16(k, i), CRC32_TABLE_ENTRIES_16(k, i + 16), \
+  CRC32_TABLE_ENTRIES_16(k, i + 32), CRC32_TABLE_ENTRIES_16(k, i + 48)
+#define CRC32_TABLE(k) { \
+  CRC32_TABLE_ENTRIES_64(k, 0), CRC32_TABLE_ENTRIES_64(k, 64), \
+  CRC32_TABLE_ENTRIES_64(k, 128), CRC32_TABLE_ENTRIES_64(k, 192) }
+
+template<uint32_t POLY>
+const uint32_t CRC32Tables<POLY>::tab[CRC32_MAX_SLICES][256] = {
+  CRC32_TABLE(0), CRC32_TABLE(1), CRC32_TABLE(2), CRC32_TABLE(3),
+  CRC32_TABLE(4), CRC32_TABLE(5), CRC32_TABLE(6), CRC32_TABLE(7),
+  CRC32_TABLE(8), CRC32_TABLE(9), CRC32_TABLE(10), CRC32_TABLE(11),
+  CRC32_TABLE(12), CRC32_TABLE(13), CRC32_TABLE(14), CRC32_TABLE(15)
+};
+
+#undef CRC32_TABLE
+#undef CRC32_TABLE_ENTRIES_64
+#undef CRC32_TABLE_ENTRIES_16
+#undef CRC32_TABLE_ENTRIES_4
+#undef CRC32_TABLE_ENTRY
+
+
+// gemeinsame Daten und Methoden aller CRC32-Implementierungen
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
+class CRC32Common {
+public:
+  // tatschlich verwendetes Polynom (ggf. mit umgekehrter Bitreihenfolge)
+  static const uint32_t EFFECTIVE_POLYNOMIAL =
+    REV? CRC32ReverseBits<POLYNOMIAL>::value : POLYNOMIAL;
+
+  CRC32Common(void)
+    : mCRC(V0)
+    , mPolynomial(EFFECTIVE_POLYNOMIAL)
+  { /* ... */ }
+
+  inline void reset(void)
+  {
+    mCRC = V0;
+  }
+
+protected:
+  typedef CRC32Tables<EFFECTIVE_POLYNOMIAL> Tables;
+
+  uint32_t mCRC;
+  uint32_t mPolynomial;
+};
+
+
 // Basis-Template-Klasse fr CRC32-Implementierungen
+//
+// CRC32Base<V0, POLYNOMIAL, REV> deklariert processBlock() rein virtuell;
+// eigene davon abgeleitete Klassen funktionieren daher unverndert, und
+// alle Implementierungen lassen sich ber Zeiger und Referenzen auf diese
+// Klasse ansprechen.
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV, class IMPL = void>
+class CRC32Base;
+
+
 template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
-class CRC32Base {
+class CRC32Base<V0, POLYNOMIAL, REV, void> : public CRC32Common<V0, POLYNOMIAL, REV> {
 public:
   CRC32Base(void)
-    : mCRC(V0)
-    , mPolynomial(REV? reverseBits(POLYNOMIAL) : POLYNOMIAL)
+    : CRC32Common<V0, POLYNOMIAL, REV>()
   { /* ... */ }
 
   virtual uint32_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd) = 0;
@@ -25,34 +141,34 @@ public:
   {
     return processBlock(buf, buf + len);
   }
+};
 
-  inline void reset(void)
-  {
-    mCRC = V0;
-  }
 
-protected:
-  uint32_t mCRC;
-  uint32_t mPolynomial;
+// IMPL ist die abgeleitete Klasse (Curiously Recurring Template Pattern):
+// process() ruft deren processBlock() direkt statt ber die vtable auf,
+// so dass der Compiler die Schleife fr jedes Polynom einzeln inlinen
+// und optimieren kann. Wer die Klasse ber CRC32Base<V0, POLYNOMIAL, REV>
+// anspricht, ruft processBlock() wie gehabt virtuell auf.
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV, class IMPL>
+class CRC32Base : public CRC32Base<V0, POLYNOMIAL, REV> {
+public:
+  CRC32Base(void)
+    : CRC32Base<V0, POLYNOMIAL, REV>()
+  { /* ... */ }
 
-private:
-  static inline uint32_t reverseBits(uint32_t x)
+  inline uint32_t process(const uint8_t* buf, int len)
   {
-    x = ((x & 0xaaaaaaaaU) >> 1) | ((x & 0x55555555U) << 1);
-    x = ((x & 0xccccccccU) >> 2) | ((x & 0x33333333U) << 2);
-    x = ((x & 0xf0f0f0f0U) >> 4) | ((x & 0x0f0f0f0fU) << 4);
-    x = ((x & 0xff00ff00U) >> 8) | ((x & 0x00ff00ffU) << 8);
-    return (x >> 16) | (x << 16);
+    return static_cast<IMPL*>(this)->IMPL::processBlock(buf, buf + len);
   }
 };
 
 
 // naiver CRC32 als Template-Klasse
 template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
-class CRC32Naive : public CRC32Base<V0, POLYNOMIAL, REV> {
+class CRC32Naive : public CRC32Base<V0, POLYNOMIAL, REV, CRC32Naive<V0, POLYNOMIAL, REV> > {
 public:
   CRC32Naive(void)
-    : CRC32Base<V0, POLYNOMIAL, REV>()
+    : CRC32Base<V0, POLYNOMIAL, REV, CRC32Naive<V0, POLYNOMIAL, REV> >()
   { /* ... */ }
 
   uint32_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd)
@@ -71,38 +187,84 @@ public:
 
 
 // optimierter CRC32 als Template-Klasse
+// (die Tabelle wird beim Kompilieren berechnet, s. CRC32Tables)
 template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
-class CRC32Optimized : public CRC32Base<V0, POLYNOMIAL, REV> {
+class CRC32Optimized : public CRC32Base<V0, POLYNOMIAL, REV, CRC32Optimized<V0, POLYNOMIAL, REV> > {
 public:
   CRC32Optimized(void)
-    : CRC32Base<V0, POLYNOMIAL, REV>()
-  {
-    makeTable();
-  }
+    : CRC32Base<V0, POLYNOMIAL, REV, CRC32Optimized<V0, POLYNOMIAL, REV> >()
+  { /* ... */ }
 
   uint32_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd)
   {
+    const uint32_t* const tab = CRC32Common<V0, POLYNOMIAL, REV>::Tables::tab[0];
     uint32_t crc = this->mCRC;
     while (buf < bufEnd)
-      crc = mTab[(crc & 0xffU) ^ *buf++] ^ (crc >> 8);
+      crc = tab[(crc & 0xffU) ^ *buf++] ^ (crc >> 8);
     this->mCRC = crc;
     return crc;
   }
+};
 
-protected:
-  void makeTable(void)
+
+// CRC32 mit "Slicing-by-N" als Template-Klasse
+//
+// Statt eines Bytes pro Tabellenzugriff werden N Bytes (N ist ein
+// Vielfaches von 4, hchstens CRC32_MAX_SLICES) pro Schleifendurchlauf
+// verarbeitet. Dazu dienen N Tabellen: Tabelle k enthlt den CRC eines
+// Bytes, auf das k Null-Bytes folgen. Die N Zugriffe sind voneinander
+// unabhngig und knnen daher parallel ausgefhrt werden.
+// Die Implementierung setzt eine Little-Endian-Architektur voraus.
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV, int N>
+class CRC32Slicing : public CRC32Base<V0, POLYNOMIAL, REV, CRC32Slicing<V0, POLYNOMIAL, REV, N> > {
+public:
+  CRC32Slicing(void)
+    : CRC32Base<V0, POLYNOMIAL, REV, CRC32Slicing<V0, POLYNOMIAL, REV, N> >()
+  { /* ... */ }
+
+  uint32_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd)
   {
-    for (int i = 0; i < 256; ++i) {
-      uint32_t bits = i;
-      int j = 8;
-      while (j--)
-        bits = (bits & 1)? (bits >> 1) ^ this->mPolynomial : bits >> 1;
-      mTab[i] = bits;
+    const uint32_t (* const tab)[256] = CRC32Common<V0, POLYNOMIAL, REV>::Tables::tab;
+    uint32_t crc = this->mCRC;
+    while (buf + N <= bufEnd) {
+      const uint32_t* words = reinterpret_cast<const uint32_t*>(buf);
+      uint32_t word = crc ^ words[0];
+      crc = 0;
+      for (int i = 0; i < N / 4; ++i) {
+        if (i > 0)
+          word = words[i];
+        crc ^= tab[N-1-4*i][word & 0xffU]
+          ^ tab[N-2-4*i][(word >> 8) & 0xffU]
+          ^ tab[N-3-4*i][(word >> 16) & 0xffU]
+          ^ tab[N-4-4*i][word >> 24];
+      }
+      buf += N;
     }
+    while (buf < bufEnd)
+      crc = tab[0][(crc & 0xffU) ^ *buf++] ^ (crc >> 8);
+    this->mCRC = crc;
+    return crc;
   }
+};
 
-private:
-  uint32_t mTab[256];
+
+// CRC32 mit Slicing-by-8 als Template-Klasse
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
+class CRC32SlicingBy8 : public CRC32Slicing<V0, POLYNOMIAL, REV, 8> {
+public:
+  CRC32SlicingBy8(void)
+    : CRC32Slicing<V0, POLYNOMIAL, REV, 8>()
+  { /* ... */ }
+};
+
+
+// CRC32 mit Slicing-by-16 als Template-Klasse
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
+class CRC32SlicingBy16 : public CRC32Slicing<V0, POLYNOMIAL, REV, 16> {
+public:
+  CRC32SlicingBy16(void)
+    : CRC32Slicing<V0, POLYNOMIAL, REV, 16>()
+  { /* ... */ }
 };
 
 #endif
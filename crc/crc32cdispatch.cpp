@@ -0,0 +1,211 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#include "crc32cdispatch.h"
+
+#include <limits.h>
+#include "cpufeatures.h"
+#include "stopwatch.h"
+#include "crcutil-fast/generic_crc.h"
+#include "crcutil-fast/crc32c_sse4.h"
+#include "crcutil-fast/crc32c_interleaved.h"
+#include "crcutil-fast/crc32c_clmul.h"
+
+
+const size_t Crc32cDispatcher::CALIBRATION_SIZES[Crc32cDispatcher::NUM_CALIBRATION_SIZES] = {
+  64, 256, 1024, 4 * 1024, 16 * 1024, 64 * 1024
+};
+
+
+// Die Kerne sind globale Objekte, damit die Funktionen, die sie aufrufen,
+// weder Parameter noch Initialisierungspruefungen benoetigen. Initialisiert
+// werden sie im Konstruktor von Crc32cDispatcher.
+static crcutil::GenericCrc<crcutil::uint64, crcutil::uint64, crcutil::uint64, 4> gGenericImpl;
+static crcutil::Crc32cSSE4 gSSE4Impl;
+static crcutil::Crc32cInterleaved gInterleavedImpl;
+static crcutil::Crc32cClmul gClmulImpl;
+static crcutil::Crc32cClmul gClmul512Impl;
+static size_t gThreshold = 0;
+
+
+// Die Funktionen haben externe Bindung, weil C++03 nur solche Funktionen
+// als Template-Parameter zulaesst (s. crc32cTiered).
+uint32_t crc32cGeneric(const void* data, size_t bytes, uint32_t crc)
+{
+  return (uint32_t)gGenericImpl.CrcDefault(data, bytes, crc);
+}
+
+uint32_t crc32cSSE4(const void* data, size_t bytes, uint32_t crc)
+{
+  return (uint32_t)gSSE4Impl.CrcDefault(data, bytes, crc);
+}
+
+uint32_t crc32cInterleaved(const void* data, size_t bytes, uint32_t crc)
+{
+  return (uint32_t)gInterleavedImpl.CrcDefault(data, bytes, crc);
+}
+
+uint32_t crc32cClmul(const void* data, size_t bytes, uint32_t crc)
+{
+  return (uint32_t)gClmulImpl.CrcDefault(data, bytes, crc);
+}
+
+uint32_t crc32cClmul512(const void* data, size_t bytes, uint32_t crc)
+{
+  return (uint32_t)gClmul512Impl.CrcDefault(data, bytes, crc);
+}
+
+
+static const Crc32cFunction KERNEL_FUNCTIONS[Crc32cDispatcher::NUM_KERNELS] = {
+  crc32cGeneric, crc32cSSE4, crc32cInterleaved, crc32cClmul, crc32cClmul512
+};
+
+
+// kurze Nachrichten mit SMALL, lange mit LARGE berechnen; beide Aufrufe
+// sind direkt und lassen sich inlinen
+template <Crc32cFunction SMALL, Crc32cFunction LARGE>
+uint32_t crc32cTiered(const void* data, size_t bytes, uint32_t crc)
+{
+  return (bytes < gThreshold)? SMALL(data, bytes, crc) : LARGE(data, bytes, crc);
+}
+
+#define CRC32C_TIERED_ROW(SMALL) { \
+  crc32cTiered<SMALL, crc32cGeneric>, crc32cTiered<SMALL, crc32cSSE4>, \
+  crc32cTiered<SMALL, crc32cInterleaved>, crc32cTiered<SMALL, crc32cClmul>, \
+  crc32cTiered<SMALL, crc32cClmul512> }
+
+static const Crc32cFunction TIERED_FUNCTIONS[Crc32cDispatcher::NUM_KERNELS][Crc32cDispatcher::NUM_KERNELS] = {
+  CRC32C_TIERED_ROW(crc32cGeneric),
+  CRC32C_TIERED_ROW(crc32cSSE4),
+  CRC32C_TIERED_ROW(crc32cInterleaved),
+  CRC32C_TIERED_ROW(crc32cClmul),
+  CRC32C_TIERED_ROW(crc32cClmul512)
+};
+
+#undef CRC32C_TIERED_ROW
+
+
+Crc32cDispatcher::Crc32cDispatcher(void)
+  : mFunction(crc32cGeneric)
+  , mSmallKernel(KERNEL_GENERIC)
+  , mLargeKernel(KERNEL_GENERIC)
+  , mThreshold(0)
+{
+  gGenericImpl.Init(crcutil::Crc32cSSE4::FixedGeneratingPolynomial(), crcutil::Crc32cSSE4::FixedDegree(), true);
+  if (isAvailable(KERNEL_SSE4))
+    gSSE4Impl.Init(true);
+  if (isAvailable(KERNEL_INTERLEAVED))
+    gInterleavedImpl.Init(true);
+  if (isAvailable(KERNEL_CLMUL))
+    gClmulImpl.Init(true, crcutil::Crc32cClmul::kPclmul128);
+  if (isAvailable(KERNEL_CLMUL512))
+    gClmul512Impl.Init(true, crcutil::Crc32cClmul::kVpclmul512);
+  calibrate();
+}
+
+
+bool Crc32cDispatcher::isAvailable(Kernel kernel)
+{
+  const CPUFeatures& cpu = CPUFeatures::instance();
+  switch (kernel) {
+  case KERNEL_GENERIC:
+    return true;
+  case KERNEL_SSE4:
+    // fall-through
+  case KERNEL_INTERLEAVED:
+    return cpu.isCRCSupported();
+  case KERNEL_CLMUL:
+    return cpu.isCRCSupported() && cpu.isClmulSupported();
+  case KERNEL_CLMUL512:
+    return cpu.isCRCSupported() && crcutil::Crc32cClmul::HasVpclmulBackend() && cpu.isVPCLMULQDQSupported();
+  default:
+    return false;
+  }
+}
+
+
+Crc32cFunction Crc32cDispatcher::kernelFunction(Kernel kernel)
+{
+  return (kernel >= 0 && kernel < NUM_KERNELS)? KERNEL_FUNCTIONS[kernel] : NULL;
+}
+
+
+const char* Crc32cDispatcher::kernelName(Kernel kernel)
+{
+  static const char* KERNEL_NAMES[NUM_KERNELS] = {
+    "GenericCrc", "Crc32cSSE4", "Crc32cInterleaved", "Crc32cClmul", "Crc32cClmul/512"
+  };
+  return (kernel >= 0 && kernel < NUM_KERNELS)? KERNEL_NAMES[kernel] : "";
+}
+
+
+// alle verfuegbaren Kerne mit Nachrichten der Groessen CALIBRATION_SIZES
+// messen; die Nachrichten stammen aus einem 64 KByte grossen Puffer, der
+// im L2-Cache liegt, damit nicht die Speicherbandbreite gemessen wird
+void Crc32cDispatcher::calibrate(void)
+{
+  static const size_t BUFFER_SIZE = 64 * 1024;
+  static const int TRIALS = 5;
+  uint8_t* buf = new uint8_t[BUFFER_SIZE];
+  uint32_t x = 0x12345678U;
+  for (size_t i = 0; i < BUFFER_SIZE; ++i) {
+    x = x * 1664525U + 1013904223U;
+    buf[i] = (uint8_t)(x >> 24);
+  }
+  volatile uint32_t sink = 0;
+  for (int k = 0; k < NUM_KERNELS; ++k) {
+    const bool available = isAvailable((Kernel)k);
+    for (int j = 0; j < NUM_CALIBRATION_SIZES; ++j) {
+      mCyclesPerByte[k][j] = 0;
+      if (!available)
+        continue;
+      const size_t size = CALIBRATION_SIZES[j];
+      int64_t ticksMin = LLONG_MAX;
+      for (int i = 0; i < TRIALS; ++i) {
+        int64_t t, ticks;
+        uint32_t crc = 0;
+        {
+          Stopwatch stopwatch(t, ticks);
+          for (size_t offset = 0; offset + size <= BUFFER_SIZE; offset += size)
+            crc ^= KERNEL_FUNCTIONS[k](buf + offset, size, 0);
+        }
+        sink ^= crc;
+        if (ticks < ticksMin)
+          ticksMin = ticks;
+      }
+      mCyclesPerByte[k][j] = (double)ticksMin / (BUFFER_SIZE / size * size);
+    }
+  }
+  delete [] buf;
+
+  // schnellster Kern fuer die kleinste und die groesste Nachrichtengroesse
+  int smallKernel = KERNEL_GENERIC;
+  int largeKernel = KERNEL_GENERIC;
+  for (int k = 1; k < NUM_KERNELS; ++k) {
+    if (mCyclesPerByte[k][0] == 0)
+      continue;
+    if (mCyclesPerByte[k][0] < mCyclesPerByte[smallKernel][0])
+      smallKernel = k;
+    if (mCyclesPerByte[k][NUM_CALIBRATION_SIZES - 1] < mCyclesPerByte[largeKernel][NUM_CALIBRATION_SIZES - 1])
+      largeKernel = k;
+  }
+
+  // Schwelle: kleinste gemessene Groesse, ab der der Kern fuer lange
+  // Nachrichten mindestens so schnell ist wie der fuer kurze
+  int j = 0;
+  while (j < NUM_CALIBRATION_SIZES - 1 && mCyclesPerByte[largeKernel][j] > mCyclesPerByte[smallKernel][j])
+    ++j;
+  if (j == 0)
+    smallKernel = largeKernel;
+  mSmallKernel = (Kernel)smallKernel;
+  mLargeKernel = (Kernel)largeKernel;
+  if (mSmallKernel == mLargeKernel) {
+    mThreshold = 0;
+    mFunction = KERNEL_FUNCTIONS[largeKernel];
+  }
+  else {
+    mThreshold = CALIBRATION_SIZES[j];
+    mFunction = TIERED_FUNCTIONS[smallKernel][largeKernel];
+  }
+  gThreshold = mThreshold;
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __CRC32CDISPATCH_H_
+#define __CRC32CDISPATCH_H_
+
+#if defined(WIN32)
+#include "gnutypes.h"
+#elif defined(__GNUC__)
+#include <stdint.h>
+#endif
+
+#include <stddef.h>
+
+
+// CRC32C (Startwert wie bei crcutil: der Wert wird vor und nach der
+// Berechnung mit 0xffffffff verknuepft; 0 ist der uebliche Startwert,
+// das Ergebnis kann als Startwert fuer den naechsten Block dienen)
+typedef uint32_t (*Crc32cFunction)(const void* data, size_t bytes, uint32_t crc);
+
+
+// Liefert die schnellste CRC32C-Implementierung fuer die CPU, auf der das
+// Programm laeuft.
+//
+// Beim ersten Aufruf von instance() fragt die Klasse einmalig CPUFeatures
+// ab und misst die verfuegbaren Kerne (GenericCrc mit Multiword-Assembler,
+// Crc32cSSE4, Crc32cInterleaved, Crc32cClmul mit 128 und 512 Bit) mit
+// Nachrichten von 64 Bytes bis 64 KByte. Der schnellste Kern fuer kurze
+// und der fuer lange Nachrichten werden samt der gemessenen Schwelle zu
+// einer Funktion kombiniert, die function() als Zeiger liefert. Sind beide
+// Kerne gleich, zeigt er direkt auf diesen Kern; andernfalls auf eine
+// fuer genau dieses Paar erzeugte Funktion, die die Kerne direkt aufruft.
+// Ein Aufruf kostet so nicht mehr als ein Funktionsaufruf ueber einen Zeiger.
+//
+// Wichtig: VC++ 2012 legt funktionslokale statische Objekte nicht
+// threadsicher an. Deshalb muss init() einmal im Hauptthread aufgerufen
+// werden, bevor andere Threads instance() benutzen; das misst die Kerne
+// ausserdem, solange keine anderen Threads die CPU belasten.
+class Crc32cDispatcher {
+private: // Singleton
+  Crc32cDispatcher(void);
+
+public:
+  enum Kernel {
+    KERNEL_GENERIC,
+    KERNEL_SSE4,
+    KERNEL_INTERLEAVED,
+    KERNEL_CLMUL,
+    KERNEL_CLMUL512,
+    NUM_KERNELS
+  };
+
+  // fuer FileCrc<> u.a., die eine Klasse mit CrcDefault() erwarten
+  typedef uint32_t Crc;
+
+  static Crc32cDispatcher& instance(void) {
+    static Crc32cDispatcher INSTANCE;
+    return INSTANCE;
+  }
+
+  // Singleton anlegen und kalibrieren (s.o.)
+  static void init(void) {
+    instance();
+  }
+
+  inline Crc32cFunction function(void) const { return mFunction; }
+  inline Kernel smallKernel(void) const { return mSmallKernel; }
+  inline Kernel largeKernel(void) const { return mLargeKernel; }
+  // ab dieser Nachrichtengroesse wird largeKernel() verwendet
+  inline size_t threshold(void) const { return mThreshold; }
+
+  inline Crc CrcDefault(const void* data, size_t bytes, const Crc& crc) const
+  {
+    return mFunction(data, bytes, crc);
+  }
+
+  // ist der Kern auf dieser CPU lauffaehig?
+  static bool isAvailable(Kernel kernel);
+  static Crc32cFunction kernelFunction(Kernel kernel);
+  static const char* kernelName(Kernel kernel);
+
+  // gemessene Taktzyklen pro Byte des Kerns fuer Nachrichten zu
+  // CALIBRATION_SIZES[size] Bytes (0, falls nicht verfuegbar)
+  inline double cyclesPerByte(Kernel kernel, int size) const { return mCyclesPerByte[kernel][size]; }
+
+  static const int NUM_CALIBRATION_SIZES = 6;
+  static const size_t CALIBRATION_SIZES[NUM_CALIBRATION_SIZES];
+
+private:
+  void calibrate(void);
+
+  Crc32cFunction mFunction;
+  Kernel mSmallKernel;
+  Kernel mLargeKernel;
+  size_t mThreshold;
+  double mCyclesPerByte[NUM_KERNELS][NUM_CALIBRATION_SIZES];
+};
+
+
+#endif // __CRC32CDISPATCH_H_
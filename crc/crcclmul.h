@@ -0,0 +1,198 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __CRCCLMUL_H_
+#define __CRCCLMUL_H_
+
+#include "crc32.h"
+#include "crcutil-fast/crc64_clmul.h"
+
+// CRC mit PCLMULQDQ fuer beliebige Polynome mit bis zu 64 Bit (CRC-16,
+// CRC-32 nach IEEE 802.3, CRC-32C, CRC-64 ...).
+//
+// Ein CRC ueber WIDTH Bits mit dem Polynom P ist in umgekehrter
+// Bitreihenfolge identisch mit dem 64-Bit-CRC ueber das Polynom
+// P * x**(64-WIDTH). Deshalb genuegt ein einziger Kern, naemlich
+// crcutil::Crc64Clmul::Fold(); nur die Konstanten zum Falten und fuer
+// die Barrett-Reduktion unterscheiden sich. Sie werden wie die Tabellen
+// in crc32.h beim Kompilieren berechnet. Die Darstellung entspricht der
+// von crcutil::GfUtil<uint64>: x**0 steht im hoechstwertigen Bit.
+//
+// Vor der Benutzung muss der Aufrufer pruefen, ob die CPU PCLMULQDQ
+// beherrscht (CPUFeatures::isClmulSupported()).
+
+// Bitreihenfolge eines 64-Bit-Werts umkehren
+template<uint64_t X>
+struct CRCClmulReverseBits {
+  static const uint64_t a = ((X & 0xaaaaaaaaaaaaaaaaULL) >> 1) | ((X & 0x5555555555555555ULL) << 1);
+  static const uint64_t b = ((a & 0xccccccccccccccccULL) >> 2) | ((a & 0x3333333333333333ULL) << 2);
+  static const uint64_t c = ((b & 0xf0f0f0f0f0f0f0f0ULL) >> 4) | ((b & 0x0f0f0f0f0f0f0f0fULL) << 4);
+  static const uint64_t d = ((c & 0xff00ff00ff00ff00ULL) >> 8) | ((c & 0x00ff00ff00ff00ffULL) << 8);
+  static const uint64_t e = ((d & 0xffff0000ffff0000ULL) >> 16) | ((d & 0x0000ffff0000ffffULL) << 16);
+  static const uint64_t value = (e >> 32) | (e << 32);
+};
+
+
+// (A * B) mod P, Bit I bis 63 von A (s. GfUtil::Multiply())
+template<uint64_t POLY, uint64_t A, uint64_t B, int I>
+struct CRCClmulMultiply {
+  static const uint64_t value = (((A >> (63 - I)) & 1U)? B : 0U) ^
+    CRCClmulMultiply<POLY, A, (B >> 1) ^ ((B & 1U)? POLY : 0U), I + 1>::value;
+};
+
+template<uint64_t POLY, uint64_t A, uint64_t B>
+struct CRCClmulMultiply<POLY, A, B, 64> {
+  static const uint64_t value = 0;
+};
+
+
+// x**N mod P durch fortgesetztes Quadrieren
+template<uint64_t POLY, int N>
+struct CRCClmulXPowN {
+  static const uint64_t half = CRCClmulXPowN<POLY, N / 2>::value;
+  static const uint64_t square = CRCClmulMultiply<POLY, half, half, 0>::value;
+  static const uint64_t value = (N & 1)? (square >> 1) ^ ((square & 1U)? POLY : 0U) : square;
+};
+
+template<uint64_t POLY>
+struct CRCClmulXPowN<POLY, 0> {
+  static const uint64_t value = 0x8000000000000000ULL;
+};
+
+
+// Polynomdivision in normaler Bitreihenfolge: I weitere Quotientenbits
+// von REM / (x**64 + POLY) an Q anhaengen
+template<uint64_t POLY, uint64_t REM, uint64_t Q, int I>
+struct CRCClmulDivide {
+  static const uint64_t value =
+    CRCClmulDivide<POLY, (REM << 1) ^ ((REM >> 63)? POLY : 0U), (Q << 1) | (REM >> 63), I - 1>::value;
+};
+
+template<uint64_t POLY, uint64_t REM, uint64_t Q>
+struct CRCClmulDivide<POLY, REM, Q, 0> {
+  static const uint64_t value = Q;
+};
+
+
+// CRC eines Bytes: ROUNDS Schiebeschritte mit Polynom POLY
+template<uint64_t POLY, uint64_t BITS, int ROUNDS>
+struct CRCClmulTableBits {
+  static const uint64_t value =
+    CRCClmulTableBits<POLY, (BITS & 1U)? ((BITS >> 1) ^ POLY) : (BITS >> 1), ROUNDS - 1>::value;
+};
+
+template<uint64_t POLY, uint64_t BITS>
+struct CRCClmulTableBits<POLY, BITS, 0> {
+  static const uint64_t value = BITS;
+};
+
+
+// Konstanten und Tabelle fuer die letzten Bytes zum Polynom POLY
+// (in umgekehrter Bitreihenfolge, ohne x**64)
+template<uint64_t POLY>
+struct CRCClmulConstants {
+  static const uint64_t POLY_NORMAL = CRCClmulReverseBits<POLY>::value;
+  // floor(x**128 / P) ohne x**64; die Division beginnt mit x**128 - x**64 * P
+  static const uint64_t MU = CRCClmulReverseBits<CRCClmulDivide<POLY_NORMAL, POLY_NORMAL, 1U, 64>::value>::value;
+  static const crcutil::Crc64Clmul::Constants k;
+  static const uint64_t tab[256];
+};
+
+template<uint64_t POLY>
+const crcutil::Crc64Clmul::Constants CRCClmulConstants<POLY>::k = {
+  { CRCClmulXPowN<POLY, 4 * 128 + 63>::value, CRCClmulXPowN<POLY, 4 * 128 - 1>::value },
+  { CRCClmulXPowN<POLY, 128 + 63>::value, CRCClmulXPowN<POLY, 128 - 1>::value },
+  { CRCClmulXPowN<POLY, 127>::value, 0U },
+  { MU, POLY }
+};
+
+#define CRCCLMUL_TABLE_ENTRY(i) CRCClmulTableBits<POLY, (i), 8>::value
+#define CRCCLMUL_TABLE_ENTRIES_4(i) \
+  CRCCLMUL_TABLE_ENTRY(i), CRCCLMUL_TABLE_ENTRY(i + 1), \
+  CRCCLMUL_TABLE_ENTRY(i + 2), CRCCLMUL_TABLE_ENTRY(i + 3)
+#define CRCCLMUL_TABLE_ENTRIES_16(i) \
+  CRCCLMUL_TABLE_ENTRIES_4(i), CRCCLMUL_TABLE_ENTRIES_4(i + 4), \
+  CRCCLMUL_TABLE_ENTRIES_4(i + 8), CRCCLMUL_TABLE_ENTRIES_4(i + 12)
+#define CRCCLMUL_TABLE_ENTRIES_64(i) \
+  CRCCLMUL_TABLE_ENTRIES_16(i), CRCCLMUL_TABLE_ENTRIES_16(i + 16), \
+  CRCCLMUL_TABLE_ENTRIES_16(i + 32), CRCCLMUL_TABLE_ENTRIES_16(i + 48)
+
+template<uint64_t POLY>
+const uint64_t CRCClmulConstants<POLY>::tab[256] = {
+  CRCCLMUL_TABLE_ENTRIES_64(0), CRCCLMUL_TABLE_ENTRIES_64(64),
+  CRCCLMUL_TABLE_ENTRIES_64(128), CRCCLMUL_TABLE_ENTRIES_64(192)
+};
+
+#undef CRCCLMUL_TABLE_ENTRIES_64
+#undef CRCCLMUL_TABLE_ENTRIES_16
+#undef CRCCLMUL_TABLE_ENTRIES_4
+#undef CRCCLMUL_TABLE_ENTRY
+
+
+// CRC mit PCLMULQDQ als Template-Klasse fuer Polynome mit WIDTH Bits
+// (ohne den hoechsten Term); V0, POLYNOMIAL und REV wie bei CRC32Base
+template<int WIDTH, uint64_t V0, uint64_t POLYNOMIAL, bool REV>
+class CRCClmul {
+public:
+  // tatsaechlich verwendetes Polynom (ggf. mit umgekehrter Bitreihenfolge)
+  static const uint64_t EFFECTIVE_POLYNOMIAL =
+    REV? (CRCClmulReverseBits<POLYNOMIAL>::value >> (64 - WIDTH)) : POLYNOMIAL;
+
+  CRCClmul(void)
+    : mCRC(V0)
+  { /* ... */ }
+
+  inline void reset(void)
+  {
+    mCRC = V0;
+  }
+
+  inline uint64_t process(const uint8_t* buf, int len)
+  {
+    return processBlock(buf, buf + len);
+  }
+
+  uint64_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd)
+  {
+    mCRC = update(mCRC, buf, (size_t)(bufEnd - buf));
+    return mCRC;
+  }
+
+  // crc ueber die bytes Bytes ab buf fortsetzen
+  static uint64_t update(uint64_t crc, const uint8_t* buf, size_t bytes)
+  {
+    typedef CRCClmulConstants<EFFECTIVE_POLYNOMIAL> Constants;
+    const uint8_t* const bufEnd = buf + bytes;
+    if (bytes >= crcutil::Crc64Clmul::kMinFoldBytes) {
+      const size_t foldBytes = bytes & ~(size_t)15;
+      crc = crcutil::Crc64Clmul::Fold(buf, foldBytes, crc, Constants::k);
+      buf += foldBytes;
+    }
+    while (buf < bufEnd)
+      crc = Constants::tab[(crc & 0xffU) ^ *buf++] ^ (crc >> 8);
+    return crc;
+  }
+
+protected:
+  uint64_t mCRC;
+};
+
+
+// CRC32 mit PCLMULQDQ als Template-Klasse, passend zu den
+// uebrigen Implementierungen in crc32.h
+template<uint32_t V0, uint32_t POLYNOMIAL, bool REV>
+class CRC32Clmul : public CRC32Base<V0, POLYNOMIAL, REV, CRC32Clmul<V0, POLYNOMIAL, REV> > {
+public:
+  CRC32Clmul(void)
+    : CRC32Base<V0, POLYNOMIAL, REV, CRC32Clmul<V0, POLYNOMIAL, REV> >()
+  { /* ... */ }
+
+  uint32_t processBlock(const uint8_t* buf, const uint8_t* const bufEnd)
+  {
+    typedef CRCClmul<32, V0, CRC32Common<V0, POLYNOMIAL, REV>::EFFECTIVE_POLYNOMIAL, false> Impl;
+    this->mCRC = (uint32_t)Impl::update(this->mCRC, buf, (size_t)(bufEnd - buf));
+    return this->mCRC;
+  }
+};
+
+#endif // __CRCCLMUL_H_
@@ -0,0 +1,109 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of many independent (small) messages in one call.
+
+#include "crc32c_batch.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#if HAVE_AMD64
+typedef uint64 CrcWord;
+#define CRC_UPDATE_WORD(crc, value) (crc = _mm_crc32_u64(crc, (value)))
+#else
+typedef uint32 CrcWord;
+#define CRC_UPDATE_WORD(crc, value) (crc = _mm_crc32_u32(crc, (value)))
+#endif  // HAVE_AMD64
+
+namespace {
+
+// Continues "crc" over "bytes" bytes at "src": word by word first, then
+// with at most one 4-, 2- and 1-byte step each.
+inline CrcWord CrcRest(CrcWord crc, const uint8 *src, size_t bytes) {
+  const uint8 *end = src + bytes;
+  while (src + sizeof(CrcWord) <= end) {
+    CRC_UPDATE_WORD(crc, reinterpret_cast<const CrcWord *>(src)[0]);
+    src += sizeof(CrcWord);
+  }
+  uint32 crc32 = static_cast<uint32>(crc);
+#if HAVE_AMD64
+  if (src + sizeof(uint32) <= end) {
+    crc32 = _mm_crc32_u32(crc32, reinterpret_cast<const uint32 *>(src)[0]);
+    src += sizeof(uint32);
+  }
+#endif  // HAVE_AMD64
+  if (src + sizeof(uint16) <= end) {
+    crc32 = _mm_crc32_u16(crc32, reinterpret_cast<const uint16 *>(src)[0]);
+    src += sizeof(uint16);
+  }
+  if (src < end) {
+    crc32 = _mm_crc32_u8(crc32, src[0]);
+  }
+  return crc32;
+}
+
+}  // namespace
+
+void Crc32cBatch::CrcBatch(const Buffer *buffers, size_t count,
+                           const Crc &start, Crc *crcs) const {
+  const CrcWord initial = static_cast<CrcWord>(start ^ Base().Canonize());
+  size_t i = 0;
+
+  // Runs kLanes messages in lockstep as long as all of them have whole
+  // words left, then finishes them one after another. The remainders
+  // are independent of each other, so the CPU overlaps them anyway.
+  for (; i + kLanes <= count; i += kLanes) {
+    const Buffer *b = buffers + i;
+    size_t words = b[0].bytes;
+    for (size_t lane = 1; lane < kLanes; ++lane) {
+      if (b[lane].bytes < words) {
+        words = b[lane].bytes;
+      }
+    }
+    words /= sizeof(CrcWord);
+
+    const CrcWord *src0 = static_cast<const CrcWord *>(b[0].data);
+    const CrcWord *src1 = static_cast<const CrcWord *>(b[1].data);
+    const CrcWord *src2 = static_cast<const CrcWord *>(b[2].data);
+    const CrcWord *src3 = static_cast<const CrcWord *>(b[3].data);
+    CrcWord crc0 = initial;
+    CrcWord crc1 = initial;
+    CrcWord crc2 = initial;
+    CrcWord crc3 = initial;
+    for (size_t w = 0; w < words; ++w) {
+      CRC_UPDATE_WORD(crc0, src0[w]);
+      CRC_UPDATE_WORD(crc1, src1[w]);
+      CRC_UPDATE_WORD(crc2, src2[w]);
+      CRC_UPDATE_WORD(crc3, src3[w]);
+    }
+
+    const size_t done = words * sizeof(CrcWord);
+    crc0 = CrcRest(crc0, reinterpret_cast<const uint8 *>(src0 + words),
+                   b[0].bytes - done);
+    crc1 = CrcRest(crc1, reinterpret_cast<const uint8 *>(src1 + words),
+                   b[1].bytes - done);
+    crc2 = CrcRest(crc2, reinterpret_cast<const uint8 *>(src2 + words),
+                   b[2].bytes - done);
+    crc3 = CrcRest(crc3, reinterpret_cast<const uint8 *>(src3 + words),
+                   b[3].bytes - done);
+    crcs[i + 0] = static_cast<Crc>(crc0) ^ Base().Canonize();
+    crcs[i + 1] = static_cast<Crc>(crc1) ^ Base().Canonize();
+    crcs[i + 2] = static_cast<Crc>(crc2) ^ Base().Canonize();
+    crcs[i + 3] = static_cast<Crc>(crc3) ^ Base().Canonize();
+  }
+
+  // Fewer messages than lanes left.
+  for (; i < count; ++i) {
+    crcs[i] = static_cast<Crc>(
+        CrcRest(initial, static_cast<const uint8 *>(buffers[i].data),
+                buffers[i].bytes)) ^ Base().Canonize();
+  }
+}
+
+#undef CRC_UPDATE_WORD
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
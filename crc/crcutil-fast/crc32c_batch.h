@@ -0,0 +1,92 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of many independent (small) messages in one call.
+//
+// A single message of 64..512 bytes is too short to be split into
+// stripes like Crc32cSSE4 or Crc32cInterleaved do, so its CRC is bound
+// by the 3-cycle latency of the crc32 instruction. Instead, CrcBatch()
+// keeps kLanes messages in flight, one dependency chain per message,
+// as long as all of them have whole words left, and finishes the
+// remainders without any byte-by-byte loop.
+
+#ifndef CRCUTIL_CRC32C_BATCH_H_
+#define CRCUTIL_CRC32C_BATCH_H_
+
+#include "gf_util.h"              // base types, gf_util class, etc.
+#include "crc32c_sse4_intrin.h"   // _mm_crc32_u* intrinsics
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cBatch {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  // Describes a single message of a batch.
+  struct Buffer {
+    const void *data;
+    size_t bytes;
+  };
+
+  Crc32cBatch() {}
+
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  explicit Crc32cBatch(bool canonical) {
+    Init(canonical);
+  }
+  void Init(bool canonical) {
+    base_.Init(FixedGeneratingPolynomial(), FixedDegree(), canonical);
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return 0x82f63b78; // 0x1edc6f41
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return 32;
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return base_; }
+
+  // Computes CRC32 of a single message.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    Buffer buffer = { data, bytes };
+    Crc result;
+    CrcBatch(&buffer, 1, crc, &result);
+    return result;
+  }
+
+  // Computes CRC32 of "count" messages described by "buffers",
+  // each one starting with "start", and stores them in crcs[0..count-1].
+  void CrcBatch(const Buffer *buffers, size_t count,
+                const Crc &start, Crc *crcs) const;
+
+ protected:
+  enum {
+    // Number of messages processed simultaneously. The crc32
+    // instruction has a latency of 3 and a throughput of 1, so
+    // 3 lanes would suffice; the 4th one covers loop overhead.
+    kLanes = 4,
+  };
+
+  GfUtil<Crc> base_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_BATCH_H_
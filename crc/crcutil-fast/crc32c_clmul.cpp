@@ -0,0 +1,299 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements CRC32C using carry-less multiplication (PCLMULQDQ).
+
+#include "crc32c_clmul.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#include <smmintrin.h>    // _mm_extract_epi32
+#include <wmmintrin.h>    // _mm_clmulepi64_si128
+#if CRCUTIL_USE_VPCLMULQDQ
+#include <immintrin.h>    // _mm512_clmulepi64_epi128
+#endif  // CRCUTIL_USE_VPCLMULQDQ
+
+namespace crcutil {
+
+// Multiplies low and high halves of "x" by respective halves of "k"
+// thus moving "x" forward by the distance encoded in "k",
+// and adds (XORs) the result to "data".
+static inline GCC_TARGET_ATTRIBUTE("sse4.1,pclmul")
+__m128i Fold128(__m128i x, __m128i k, __m128i data) {
+  __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+  __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(lo, hi), data);
+}
+
+#define LOAD_128(src, index) \
+  _mm_loadu_si128(reinterpret_cast<const __m128i *>(src) + (index))
+
+#if CRCUTIL_USE_VPCLMULQDQ
+
+#define AVX512_TARGET "avx512f,avx2,vpclmulqdq,pclmul,sse4.1"
+
+#define LOAD_512(src, index) \
+  _mm512_loadu_si512(reinterpret_cast<const __m512i *>(src) + (index))
+
+// Lanes are extracted with the zero-masking variants of the intrinsics
+// and all elements selected, which compile to the same instructions.
+// The plain variants pass _mm512_undefined_epi32() as merge source, and
+// GCC 12 warns about that inside avx512fintrin.h (-Wuninitialized).
+#define EXTRACT_256(x, index) _mm512_maskz_extracti64x4_epi64(0xf, x, index)
+#define EXTRACT_128(x, index) _mm512_maskz_extracti32x4_epi32(0xf, x, index)
+
+// Same as Fold128 but for each of the four 128-bit lanes.
+static inline GCC_TARGET_ATTRIBUTE(AVX512_TARGET)
+__m512i Fold512(__m512i x, __m512i k, __m512i data) {
+  __m512i lo = _mm512_clmulepi64_epi128(x, k, 0x00);
+  __m512i hi = _mm512_clmulepi64_epi128(x, k, 0x11);
+  // 0x96 is the truth table of three-way XOR.
+  return _mm512_ternarylogic_epi64(lo, hi, data, 0x96);
+}
+
+// Folds "bytes" bytes starting at "src" (a multiple of 64, not less
+// than 4 x 64) into a single 128-bit accumulator which is congruent
+// to the input and positioned at its last 128 bits.
+static GCC_TARGET_ATTRIBUTE(AVX512_TARGET)
+__m128i FoldWide(const uint8 *src, size_t bytes, uint32 crc,
+                 const uint64 *k_fold_4x512,
+                 const uint64 *k_fold_1x512,
+                 const uint64 *k_fold_lanes) {
+  __m512i x0 = LOAD_512(src, 0);
+  __m512i x1 = LOAD_512(src, 1);
+  __m512i x2 = LOAD_512(src, 2);
+  __m512i x3 = LOAD_512(src, 3);
+  x0 = _mm512_xor_si512(x0, _mm512_inserti32x4(
+      _mm512_setzero_si512(), _mm_cvtsi32_si128(static_cast<int>(crc)), 0));
+  src += 4 * sizeof(__m512i);
+  bytes -= 4 * sizeof(__m512i);
+
+  // Fold 4 x 512 bits at a time.
+  __m512i k = LOAD_512(k_fold_4x512, 0);
+  while (bytes >= 4 * sizeof(__m512i)) {
+    x0 = Fold512(x0, k, LOAD_512(src, 0));
+    x1 = Fold512(x1, k, LOAD_512(src, 1));
+    x2 = Fold512(x2, k, LOAD_512(src, 2));
+    x3 = Fold512(x3, k, LOAD_512(src, 3));
+    src += 4 * sizeof(__m512i);
+    bytes -= 4 * sizeof(__m512i);
+  }
+
+  // Fold 4 accumulators into one, then process remaining 512-bit words.
+  k = LOAD_512(k_fold_1x512, 0);
+  x0 = Fold512(x0, k, x1);
+  x0 = Fold512(x0, k, x2);
+  x0 = Fold512(x0, k, x3);
+  while (bytes >= sizeof(__m512i)) {
+    x0 = Fold512(x0, k, LOAD_512(src, 0));
+    src += sizeof(__m512i);
+    bytes -= sizeof(__m512i);
+  }
+
+  // Move lanes 0..2 onto lane 3 and add them up.
+  k = LOAD_512(k_fold_lanes, 0);
+  x1 = Fold512(x0, k, _mm512_setzero_si512());
+  __m256i y = _mm256_xor_si256(EXTRACT_256(x1, 0), EXTRACT_256(x1, 1));
+  __m128i x = _mm_xor_si128(_mm256_castsi256_si128(y),
+                            _mm256_extracti128_si256(y, 1));
+  return _mm_xor_si128(x, EXTRACT_128(x0, 3));
+}
+
+#undef EXTRACT_128
+#undef EXTRACT_256
+#undef LOAD_512
+
+#endif  // CRCUTIL_USE_VPCLMULQDQ
+
+GCC_TARGET_ATTRIBUTE("sse4.1,pclmul")
+uint32 Crc32cClmul::Fold(const uint8 *src, size_t bytes, uint32 crc) const {
+  __m128i x0;
+  __m128i x1;
+  __m128i k = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(k_fold_1x128_));
+
+#if CRCUTIL_USE_VPCLMULQDQ
+  if (backend_ == kVpclmul512 && bytes >= kMinWideFoldBytes) {
+    size_t wide_bytes = bytes & ~static_cast<size_t>(sizeof(__m512i) - 1);
+    x0 = FoldWide(src, wide_bytes, crc,
+                  k_fold_4x512_, k_fold_1x512_, k_fold_lanes_);
+    src += wide_bytes;
+    bytes -= wide_bytes;
+  } else
+#endif  // CRCUTIL_USE_VPCLMULQDQ
+  {
+    x0 = LOAD_128(src, 0);
+    x1 = LOAD_128(src, 1);
+    __m128i x2 = LOAD_128(src, 2);
+    __m128i x3 = LOAD_128(src, 3);
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    src += kFoldBytes;
+    bytes -= kFoldBytes;
+
+    // Fold 4 x 128 bits at a time.
+    __m128i k4 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(k_fold_4x128_));
+    while (bytes >= kFoldBytes) {
+      x0 = Fold128(x0, k4, LOAD_128(src, 0));
+      x1 = Fold128(x1, k4, LOAD_128(src, 1));
+      x2 = Fold128(x2, k4, LOAD_128(src, 2));
+      x3 = Fold128(x3, k4, LOAD_128(src, 3));
+      src += kFoldBytes;
+      bytes -= kFoldBytes;
+    }
+
+    // Fold 4 accumulators into one.
+    x0 = Fold128(x0, k, x1);
+    x0 = Fold128(x0, k, x2);
+    x0 = Fold128(x0, k, x3);
+  }
+
+  // Process remaining 128-bit words.
+  while (bytes >= sizeof(__m128i)) {
+    x0 = Fold128(x0, k, LOAD_128(src, 0));
+    src += sizeof(__m128i);
+    bytes -= sizeof(__m128i);
+  }
+
+  // Fold 128 bits to 64 bits.
+  const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_clmulepi64_si128(x0, k, 0x10);
+  x0 = _mm_xor_si128(_mm_srli_si128(x0, 8), x1);
+  k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(k_fold_64_));
+  x1 = _mm_srli_si128(x0, 4);
+  x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k, 0x00);
+  x0 = _mm_xor_si128(x0, x1);
+
+  // Barrett reduction of 64 bits to 32 bits.
+  k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(k_barrett_));
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k, 0x10);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00);
+  x0 = _mm_xor_si128(x0, x1);
+  return static_cast<uint32>(_mm_extract_epi32(x0, 1));
+}
+
+#undef LOAD_128
+
+size_t Crc32cClmul::Crc32c(const void *data, size_t bytes, Crc crc) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  const uint8 *end = src + bytes;
+  crc ^= Base().Canonize();
+
+  if (bytes >= kMinFoldBytes) {
+    size_t fold_bytes = bytes & ~static_cast<size_t>(sizeof(__m128i) - 1);
+    crc = Fold(src, fold_bytes, static_cast<uint32>(crc));
+    src += fold_bytes;
+  }
+
+  // Finish the tail word-by-word and then byte-by-byte.
+#if HAVE_AMD64
+  while (src + sizeof(uint64) <= end) {
+    crc = static_cast<Crc>(_mm_crc32_u64(
+        crc, reinterpret_cast<const uint64 *>(src)[0]));
+    src += sizeof(uint64);
+  }
+#else
+  while (src + sizeof(uint32) <= end) {
+    crc = _mm_crc32_u32(crc, reinterpret_cast<const uint32 *>(src)[0]);
+    src += sizeof(uint32);
+  }
+#endif  // HAVE_AMD64
+  while (src < end) {
+    crc = _mm_crc32_u8(static_cast<uint32>(crc), src[0]);
+    src += 1;
+  }
+
+  return (crc ^ Base().Canonize());
+}
+
+
+void Crc32cClmul::Init(bool canonical, Backend backend) {
+  base_.Init(FixedGeneratingPolynomial(), FixedDegree(), canonical);
+  backend_ = HasVpclmulBackend() ? backend : kPclmul128;
+
+#define REFLECTED_X_POW_N(n) (static_cast<uint64>(Base().XpowN(n)) << 1)
+
+  k_fold_4x128_[0] = REFLECTED_X_POW_N(4 * 128 + 32);
+  k_fold_4x128_[1] = REFLECTED_X_POW_N(4 * 128 - 32);
+  k_fold_1x128_[0] = REFLECTED_X_POW_N(128 + 32);
+  k_fold_1x128_[1] = REFLECTED_X_POW_N(128 - 32);
+  k_fold_64_[0] = REFLECTED_X_POW_N(64);
+  k_fold_64_[1] = 0;
+  for (size_t lane = 0; lane < 4; ++lane) {
+    k_fold_4x512_[2 * lane + 0] = REFLECTED_X_POW_N(4 * 512 + 32);
+    k_fold_4x512_[2 * lane + 1] = REFLECTED_X_POW_N(4 * 512 - 32);
+    k_fold_1x512_[2 * lane + 0] = REFLECTED_X_POW_N(512 + 32);
+    k_fold_1x512_[2 * lane + 1] = REFLECTED_X_POW_N(512 - 32);
+  }
+  for (size_t lane = 0; lane < 3; ++lane) {
+    size_t distance = 128 * (3 - lane);
+    k_fold_lanes_[2 * lane + 0] = REFLECTED_X_POW_N(distance + 32);
+    k_fold_lanes_[2 * lane + 1] = REFLECTED_X_POW_N(distance - 32);
+  }
+  k_fold_lanes_[6] = 0;
+  k_fold_lanes_[7] = 0;
+
+#undef REFLECTED_X_POW_N
+
+  // Compute floor(x**64 / P) by long division in normal (non-reflected)
+  // bit order, then reflect the 33-bit quotient.
+  uint64 poly = 0;
+  for (size_t i = 0; i < FixedDegree(); ++i) {
+    if ((FixedGeneratingPolynomial() >> i) & 1) {
+      poly |= static_cast<uint64>(1) << (FixedDegree() - 1 - i);
+    }
+  }
+  poly |= static_cast<uint64>(1) << FixedDegree();
+  uint64 remainder = (static_cast<uint64>(1) << FixedDegree()) ^ poly;
+  uint64 quotient = 1;
+  for (size_t i = 0; i < 64 - FixedDegree(); ++i) {
+    remainder <<= 1;
+    quotient <<= 1;
+    if (remainder & (static_cast<uint64>(1) << FixedDegree())) {
+      remainder ^= poly;
+      quotient |= 1;
+    }
+  }
+  uint64 mu = 0;
+  for (size_t i = 0; i <= 64 - FixedDegree(); ++i) {
+    if ((quotient >> i) & 1) {
+      mu |= static_cast<uint64>(1) << (64 - FixedDegree() - i);
+    }
+  }
+  k_barrett_[0] = (static_cast<uint64>(FixedGeneratingPolynomial()) << 1) | 1;
+  k_barrett_[1] = mu;
+}
+
+
+bool Crc32cClmul::IsClmulAvailable() {
+#if defined(_MSC_VER)
+  int cpu_info[4];
+  __cpuid(cpu_info, 1);
+  return ((cpu_info[2] & (1 << 1)) != 0 && (cpu_info[2] & (1 << 20)) != 0);
+#elif defined(__GNUC__) && (HAVE_AMD64 || HAVE_I386)
+  // Not using "cpuid.h" intentionally: it is missing from
+  // too many installations.
+  uint32 eax;
+  uint32 ecx;
+  uint32 edx;
+  __asm__ volatile(
+#if HAVE_I386 && defined(__PIC__)
+    "push ebx\n"
+    "cpuid\n"
+    "pop ebx\n"
+#else
+    "cpuid\n"
+#endif  // HAVE_I386 && defined(__PIC__)
+    : "=a" (eax), "=c" (ecx), "=d" (edx)
+    : "a" (1), "2" (0)
+    : "%ebx"
+  );
+  return ((ecx & (1 << 1)) != 0 && (ecx & (1 << 20)) != 0);
+#else
+  return false;
+#endif
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
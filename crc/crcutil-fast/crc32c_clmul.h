@@ -0,0 +1,166 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements CRC32C using carry-less multiplication (PCLMULQDQ).
+//
+// Input data is folded into 4 independent 128-bit accumulators,
+// 64 bytes per iteration. Since folding does not depend on the
+// 3-cycle latency of the crc32 instruction, large inputs are limited
+// by memory bandwidth and PCLMULQDQ throughput only. Accumulators are
+// folded into a single 128-bit value which is reduced to 32 bits
+// using Barrett reduction.
+//
+// On processors supporting AVX-512 and VPCLMULQDQ, the kVpclmul512
+// backend folds 4 x 512 bits (four 128-bit lanes per register) per
+// iteration instead. The caller selects the backend at runtime since
+// the library itself does not query extended CPU features.
+//
+// See "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+// Instruction" by V. Gopal et al. (Intel, 2009) for the math behind it.
+
+#ifndef CRCUTIL_CRC32C_CLMUL_H_
+#define CRCUTIL_CRC32C_CLMUL_H_
+
+#include "gf_util.h"              // base types, gf_util class, etc.
+#include "crc32c_sse4_intrin.h"   // _mm_crc32_u* intrinsics
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+// VPCLMULQDQ intrinsics are available since GCC 8 and Visual Studio 2019.
+#if !defined(CRCUTIL_USE_VPCLMULQDQ)
+#if HAVE_AMD64 && (GCC_VERSION_AVAILABLE(8, 0) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1920))
+#define CRCUTIL_USE_VPCLMULQDQ 1
+#else
+#define CRCUTIL_USE_VPCLMULQDQ 0
+#endif
+#endif  // !defined(CRCUTIL_USE_VPCLMULQDQ)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cClmul {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  enum Backend {
+    // 4 x 128-bit folding using PCLMULQDQ.
+    kPclmul128,
+
+    // 4 x 512-bit folding using VPCLMULQDQ (requires AVX-512F).
+    kVpclmul512,
+  };
+
+  Crc32cClmul() : backend_(kPclmul128) {}
+
+  // Initializes folding constants.
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  // If "backend" is not compiled in, kPclmul128 is used instead.
+  explicit Crc32cClmul(bool canonical, Backend backend = kPclmul128) {
+    Init(canonical, backend);
+  }
+  void Init(bool canonical, Backend backend = kPclmul128);
+
+  // Initializes folding constants given generating polynomial of degree.
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  // Provided for compatibility with GenericCrc.
+  Crc32cClmul(const Crc &generating_polynomial,
+              size_t degree,
+              bool canonical) {
+    Init(generating_polynomial, degree, canonical);
+  }
+  void Init(const Crc &generating_polynomial,
+            size_t degree,
+            bool canonical) {
+    if (generating_polynomial == FixedGeneratingPolynomial() &&
+        degree == FixedDegree()) {
+      Init(canonical);
+    }
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return 0x82f63b78; // 0x1edc6f41
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return 32;
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return base_; }
+
+  // Computes CRC32.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    return Crc32c(data, bytes, crc);
+  }
+
+  // Returns backend actually in use.
+  Backend GetBackend() const { return backend_; }
+
+  // Returns true iff both pclmulqdq and crc32 instructions are available.
+  static bool IsClmulAvailable();
+
+  // Returns true iff kVpclmul512 backend was compiled in.
+  // Whether the CPU supports it has to be checked by the caller.
+  static bool HasVpclmulBackend() {
+    return (CRCUTIL_USE_VPCLMULQDQ != 0);
+  }
+
+ protected:
+  // Actual implementation.
+  size_t Crc32c(const void *data, size_t bytes, Crc crc) const;
+
+  // Folds "bytes" bytes starting at "src" and returns the resulting
+  // (non-canonized) CRC. "bytes" shall be a multiple of 16 and
+  // shall not be less than kFoldBytes.
+  uint32 Fold(const uint8 *src, size_t bytes, uint32 crc) const;
+
+  enum {
+    kFoldBytes = 4 * 16,
+
+    // Below this size, the overhead of loading the constants and
+    // reducing the accumulators does not pay off and crc32
+    // instruction is used instead.
+    kMinFoldBytes = 4 * kFoldBytes,
+
+    kWideFoldBytes = 4 * 64,
+    kMinWideFoldBytes = 4 * kWideFoldBytes,
+  };
+
+  // Folding constants: bit-reflected (x**n mod P) << 1,
+  // where n is the folding distance in bits (+/- 32).
+  uint64 k_fold_4x128_[2];
+  uint64 k_fold_1x128_[2];
+  uint64 k_fold_64_[2];
+
+  // Folding constants used by kVpclmul512 backend: 4 x 512 bits,
+  // 1 x 512 bits (both repeated for each of the four lanes of a 512-bit
+  // register), and distinct constants for each of the four lanes
+  // (last lane is not moved).
+  uint64 k_fold_4x512_[8];
+  uint64 k_fold_1x512_[8];
+  uint64 k_fold_lanes_[8];
+
+  // Bit-reflected generating polynomial (33 bits) and
+  // bit-reflected floor(x**64 / P) used by Barrett reduction.
+  uint64 k_barrett_[2];
+
+  GfUtil<Crc> base_;
+  Backend backend_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_CLMUL_H_
@@ -0,0 +1,82 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Copies a block of memory and computes its CRC32C in the same pass.
+
+#include "crc32c_copy.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#include <emmintrin.h>            // _mm_loadu_si128, _mm_stream_si128, etc.
+
+namespace crcutil {
+
+namespace {
+
+// Copies "bytes" bytes using non-temporal stores. Bytes in front of
+// the first and behind the last 16-byte aligned destination address
+// are copied with regular stores.
+void CopyNonTemporal(uint8 *dst, const uint8 *src, size_t bytes) {
+  size_t head = (0 - reinterpret_cast<size_t>(dst)) & (sizeof(__m128i) - 1);
+  if (head > bytes) {
+    head = bytes;
+  }
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  bytes -= head;
+
+  for (; bytes >= 4 * sizeof(__m128i); bytes -= 4 * sizeof(__m128i)) {
+    const __m128i *s = reinterpret_cast<const __m128i *>(src);
+    __m128i *d = reinterpret_cast<__m128i *>(dst);
+    const __m128i v0 = _mm_loadu_si128(s + 0);
+    const __m128i v1 = _mm_loadu_si128(s + 1);
+    const __m128i v2 = _mm_loadu_si128(s + 2);
+    const __m128i v3 = _mm_loadu_si128(s + 3);
+    _mm_stream_si128(d + 0, v0);
+    _mm_stream_si128(d + 1, v1);
+    _mm_stream_si128(d + 2, v2);
+    _mm_stream_si128(d + 3, v3);
+    src += 4 * sizeof(__m128i);
+    dst += 4 * sizeof(__m128i);
+  }
+  for (; bytes >= sizeof(__m128i); bytes -= sizeof(__m128i)) {
+    _mm_stream_si128(reinterpret_cast<__m128i *>(dst),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+    src += sizeof(__m128i);
+    dst += sizeof(__m128i);
+  }
+
+  memcpy(dst, src, bytes);
+}
+
+}  // namespace
+
+size_t Crc32cCopy::CrcCopy(void *dst, const void *src, size_t bytes,
+                           const Crc &crc, bool non_temporal) const {
+  uint8 *d = static_cast<uint8 *>(dst);
+  const uint8 *s = static_cast<const uint8 *>(src);
+  Crc result = crc;
+  while (bytes != 0) {
+    const size_t piece = (bytes < kPieceBytes) ? bytes : kPieceBytes;
+    if (non_temporal) {
+      CopyNonTemporal(d, s, piece);
+    } else {
+      memcpy(d, s, piece);
+    }
+    // The source piece has just been read and is still in the L1 cache.
+    result = crc_.CrcDefault(s, piece, result);
+    d += piece;
+    s += piece;
+    bytes -= piece;
+  }
+  if (non_temporal) {
+    // Make the non-temporal stores globally visible before returning.
+    _mm_sfence();
+  }
+  return result;
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
@@ -0,0 +1,84 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Copies a block of memory and computes its CRC32C in the same pass.
+//
+// memcpy() followed by Crc32cSSE4::CrcDefault() reads the source twice;
+// if the block does not fit into the cache, the second read has to go
+// to main memory again. CrcCopy() instead copies the block in pieces
+// of kPieceBytes and computes the CRC of each piece right after copying
+// it, while the piece is still in the L1 cache. Main memory is read
+// only once, and the CRC is still computed by the fast Crc32cSSE4 code.
+//
+// With "non_temporal" set, stores bypass the cache (movntdq). Use it for
+// copies much larger than the last level cache whose destination is not
+// going to be read soon; otherwise regular stores are faster.
+
+#ifndef CRCUTIL_CRC32C_COPY_H_
+#define CRCUTIL_CRC32C_COPY_H_
+
+#include "crc32c_sse4.h"          // Crc32cSSE4
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cCopy {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  Crc32cCopy() {}
+
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  explicit Crc32cCopy(bool canonical) {
+    Init(canonical);
+  }
+  void Init(bool canonical) {
+    crc_.Init(canonical);
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return Crc32cSSE4::FixedGeneratingPolynomial();
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return Crc32cSSE4::FixedDegree();
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return crc_.Base(); }
+
+  // Computes CRC32.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    return crc_.CrcDefault(data, bytes, crc);
+  }
+
+  // Copies "bytes" bytes from "src" to "dst" and returns CRC32 of them.
+  // The blocks must not overlap.
+  size_t CrcCopy(void *dst, const void *src, size_t bytes, const Crc &crc,
+                 bool non_temporal = false) const;
+
+ protected:
+  enum {
+    // Fits into the L1 cache together with the destination piece.
+    kPieceBytes = 4 * 1024,
+  };
+
+  Crc32cSSE4 crc_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_COPY_H_
@@ -0,0 +1,94 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of a message scattered over several segments.
+
+#include "crc32c_gather.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+// CRC_UPDATE_WORD() comes from crc32c_sse4.h.
+
+void Crc32cGather::Update(const void *data, size_t bytes,
+                          State *state) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  const uint8 *end = src + bytes;
+  Word crc = state->crc;
+  Word pending = state->pending;
+  size_t pending_bytes = state->pending_bytes;
+
+  if (bytes < sizeof(Word)) {
+    // Segment is shorter than a word: append it to the pending bytes
+    // and feed them into the CRC once a word is complete.
+    if (bytes == 0) {
+      return;
+    }
+    Word value = 0;
+    memcpy(&value, src, bytes);
+    pending |= value << (8 * pending_bytes);
+    pending_bytes += bytes;
+    if (pending_bytes >= sizeof(Word)) {
+      CRC_UPDATE_WORD(crc, pending);
+      pending_bytes -= sizeof(Word);
+      // pending_bytes was non-zero before, so the shift is in range.
+      pending = value >> (8 * (bytes - pending_bytes));
+    }
+    state->crc = crc;
+    state->pending = pending;
+    state->pending_bytes = pending_bytes;
+    return;
+  }
+
+  // Complete the pending word with the first bytes of this segment.
+  if (pending_bytes != 0) {
+    pending |= reinterpret_cast<const Word *>(src)[0] << (8 * pending_bytes);
+    CRC_UPDATE_WORD(crc, pending);
+    src += sizeof(Word) - pending_bytes;
+  }
+
+  // Whole words in between.
+  const size_t words = static_cast<size_t>(end - src) / sizeof(Word);
+  if (words != 0) {
+    crc = crc_.CrcDefault(src, words * sizeof(Word), crc);
+    src += words * sizeof(Word);
+  }
+
+  // Keep the last (less than sizeof(Word)) bytes for the next segment.
+  // The segment is at least a word long, so the last word of it
+  // can be loaded and shifted into place.
+  pending_bytes = static_cast<size_t>(end - src);
+  pending = 0;
+  if (pending_bytes != 0) {
+    pending = reinterpret_cast<const Word *>(end - sizeof(Word))[0] >>
+        (8 * (sizeof(Word) - pending_bytes));
+  }
+
+  state->crc = crc;
+  state->pending = pending;
+  state->pending_bytes = pending_bytes;
+}
+
+Crc32cGather::Crc Crc32cGather::Finish(const State &state) const {
+  Word pending = state.pending;
+  uint32 crc = static_cast<uint32>(state.crc);
+#if HAVE_AMD64
+  if ((state.pending_bytes & 4) != 0) {
+    crc = _mm_crc32_u32(crc, static_cast<uint32>(pending));
+    pending >>= 32;
+  }
+#endif  // HAVE_AMD64
+  if ((state.pending_bytes & 2) != 0) {
+    crc = _mm_crc32_u16(crc, static_cast<uint16>(pending));
+    pending >>= 16;
+  }
+  if ((state.pending_bytes & 1) != 0) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8>(pending));
+  }
+  return (static_cast<Crc>(crc) ^ Base().Canonize());
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
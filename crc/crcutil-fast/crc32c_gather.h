@@ -0,0 +1,126 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of a message scattered over several segments
+// (e.g. header, payload, and trailer of a packet) without copying
+// the segments into a contiguous buffer first.
+//
+// Segment boundaries need not be word-aligned: up to sizeof(Word) - 1
+// bytes left over at the end of a segment are kept in a pending word
+// and completed with a single unaligned load from the next segment.
+// Whole words in between are handed to Crc32cSSE4.
+
+#ifndef CRCUTIL_CRC32C_GATHER_H_
+#define CRCUTIL_CRC32C_GATHER_H_
+
+#include "crc32c_sse4.h"          // Crc32cSSE4, _mm_crc32_u* intrinsics
+
+#if !defined(_MSC_VER)
+#include <sys/uio.h>              // struct iovec
+#endif  // !defined(_MSC_VER)
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cGather {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  // Describes a single segment of a message.
+  struct Segment {
+    const void *data;
+    size_t bytes;
+  };
+
+  // State carried from one segment to the next.
+  struct State {
+    Word crc;
+    Word pending;           // Bytes not yet fed into crc, lowest first.
+    size_t pending_bytes;   // Number of valid bytes in pending.
+  };
+
+  Crc32cGather() {}
+
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  explicit Crc32cGather(bool canonical) {
+    Init(canonical);
+  }
+  void Init(bool canonical) {
+    base_.Init(FixedGeneratingPolynomial(), FixedDegree(), canonical);
+    crc_.Init(false);
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return 0x82f63b78; // 0x1edc6f41
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return 32;
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return base_; }
+
+  // Computes CRC32 of a single contiguous message.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    State state;
+    Start(crc, &state);
+    Update(data, bytes, &state);
+    return Finish(state);
+  }
+
+  // Computes CRC32 of the concatenation of "count" segments.
+  size_t CrcGather(const Segment *segments, size_t count,
+                   const Crc &crc) const {
+    State state;
+    Start(crc, &state);
+    for (size_t i = 0; i < count; ++i) {
+      Update(segments[i].data, segments[i].bytes, &state);
+    }
+    return Finish(state);
+  }
+
+#if !defined(_MSC_VER)
+  // Same as above, for the segments of readv()/writev().
+  size_t CrcGather(const struct iovec *iov, int iovcnt,
+                   const Crc &crc) const {
+    State state;
+    Start(crc, &state);
+    for (int i = 0; i < iovcnt; ++i) {
+      Update(iov[i].iov_base, iov[i].iov_len, &state);
+    }
+    return Finish(state);
+  }
+#endif  // !defined(_MSC_VER)
+
+  // Incremental interface: Start(), then Update() for each segment
+  // in order, then Finish() to obtain the CRC.
+  void Start(const Crc &crc, State *state) const {
+    state->crc = crc ^ Base().Canonize();
+    state->pending = 0;
+    state->pending_bytes = 0;
+  }
+  void Update(const void *data, size_t bytes, State *state) const;
+  Crc Finish(const State &state) const;
+
+ protected:
+  GfUtil<Crc> base_;
+  Crc32cSSE4 crc_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_GATHER_H_
@@ -0,0 +1,112 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements CRC32C using three interleaved streams of crc32 instructions.
+
+#include "crc32c_interleaved.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#if HAVE_AMD64
+typedef uint64 CrcWord;
+#define CRC_UPDATE_WORD(crc, value) (crc = _mm_crc32_u64(crc, (value)))
+#else
+typedef uint32 CrcWord;
+#define CRC_UPDATE_WORD(crc, value) (crc = _mm_crc32_u32(crc, (value)))
+#endif  // HAVE_AMD64
+
+// Multiples of 4 words (32 bytes), see the unrolled loop below.
+const size_t Crc32cInterleaved::kStripeBytes[kNumStripeSizes] = {
+  10912,
+  1344,
+  320,
+  160,
+};
+
+inline Crc32cInterleaved::Crc Crc32cInterleaved::MultiplyCrc(
+    size_t size, Crc crc) const {
+  const Entry (*table)[kTableEntries] = mul_table_[size];
+  return table[0][crc & (kTableEntries - 1)] ^
+         table[1][(crc >> kTableEntryBits) & (kTableEntries - 1)] ^
+         table[2][(crc >> (2 * kTableEntryBits)) & (kTableEntries - 1)] ^
+         table[3][(crc >> (3 * kTableEntryBits)) & (kTableEntries - 1)];
+}
+
+
+size_t Crc32cInterleaved::Crc32c(const void *data, size_t bytes,
+                                 Crc crc) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  const uint8 *end = src + bytes;
+  crc ^= Base().Canonize();
+
+  CrcWord crc0 = static_cast<CrcWord>(crc);
+  for (size_t size = 0; size < kNumStripeSizes; ++size) {
+    const size_t stripe_words = kStripeBytes[size] / sizeof(CrcWord);
+    while (src + kNumStripes * kStripeBytes[size] <= end) {
+      const CrcWord *s0 = reinterpret_cast<const CrcWord *>(src);
+      const CrcWord *s1 = s0 + stripe_words;
+      const CrcWord *s2 = s1 + stripe_words;
+      CrcWord crc1 = 0;
+      CrcWord crc2 = 0;
+      // Unrolled 4 times: all stripe sizes are multiples of 4 words,
+      // and the loop overhead would otherwise cost a cycle every
+      // 3 crc32 instructions.
+      for (size_t i = 0; i < stripe_words; i += 4) {
+        CRC_UPDATE_WORD(crc0, s0[i]);
+        CRC_UPDATE_WORD(crc1, s1[i]);
+        CRC_UPDATE_WORD(crc2, s2[i]);
+        CRC_UPDATE_WORD(crc0, s0[i + 1]);
+        CRC_UPDATE_WORD(crc1, s1[i + 1]);
+        CRC_UPDATE_WORD(crc2, s2[i + 1]);
+        CRC_UPDATE_WORD(crc0, s0[i + 2]);
+        CRC_UPDATE_WORD(crc1, s1[i + 2]);
+        CRC_UPDATE_WORD(crc2, s2[i + 2]);
+        CRC_UPDATE_WORD(crc0, s0[i + 3]);
+        CRC_UPDATE_WORD(crc1, s1[i + 3]);
+        CRC_UPDATE_WORD(crc2, s2[i + 3]);
+      }
+      // ((crc0 * x**(8S)) ^ crc1) * x**(8S) ^ crc2
+      crc0 = static_cast<CrcWord>(
+          MultiplyCrc(size, MultiplyCrc(size, static_cast<Crc>(crc0)) ^
+                            static_cast<Crc>(crc1)) ^
+          static_cast<Crc>(crc2));
+      src += kNumStripes * kStripeBytes[size];
+    }
+  }
+
+  // Finish the tail word-by-word and then byte-by-byte.
+  while (src + sizeof(CrcWord) <= end) {
+    CRC_UPDATE_WORD(crc0, reinterpret_cast<const CrcWord *>(src)[0]);
+    src += sizeof(CrcWord);
+  }
+  while (src < end) {
+    crc0 = _mm_crc32_u8(static_cast<uint32>(crc0), src[0]);
+    src += 1;
+  }
+
+  return (static_cast<Crc>(crc0) ^ Base().Canonize());
+}
+
+#undef CRC_UPDATE_WORD
+
+
+void Crc32cInterleaved::Init(bool canonical) {
+  base_.Init(FixedGeneratingPolynomial(), FixedDegree(), canonical);
+  for (size_t size = 0; size < kNumStripeSizes; ++size) {
+    const Crc multiplier = Base().Xpow8N(kStripeBytes[size]);
+    for (size_t table = 0; table < kNumTables; ++table) {
+      for (size_t entry = 0; entry < kTableEntries; ++entry) {
+        const Crc value =
+            static_cast<uint32>(entry << (kTableEntryBits * table));
+        mul_table_[size][table][entry] =
+            static_cast<Entry>(Base().Multiply(value, multiplier));
+      }
+    }
+  }
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
@@ -0,0 +1,123 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements CRC32C using three interleaved streams of crc32 instructions.
+//
+// The crc32 instruction has a latency of 3 cycles but a throughput of
+// one instruction per cycle. A single dependency chain therefore
+// processes at most 8 bytes every 3 cycles. Splitting a block into
+// three stripes of equal size and running one chain per stripe keeps
+// the CRC unit busy every cycle. The CRCs of the stripes are merged
+// the same way Crc32cSSE4 does it: by multiplying them with
+// x**(8 * stripe size) using one lookup table per byte of the CRC.
+//
+// With one set of 4 tables per stripe size the tables take 16 KB,
+// so constructing the class is still cheap.
+
+#ifndef CRCUTIL_CRC32C_INTERLEAVED_H_
+#define CRCUTIL_CRC32C_INTERLEAVED_H_
+
+#include "gf_util.h"              // base types, gf_util class, etc.
+#include "crc32c_sse4_intrin.h"   // _mm_crc32_u* intrinsics
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cInterleaved {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  Crc32cInterleaved() {}
+
+  // Initializes merge constants.
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  explicit Crc32cInterleaved(bool canonical) {
+    Init(canonical);
+  }
+  void Init(bool canonical);
+
+  // Initializes merge constants given generating polynomial of degree.
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  // Provided for compatibility with GenericCrc.
+  Crc32cInterleaved(const Crc &generating_polynomial,
+                    size_t degree,
+                    bool canonical) {
+    Init(generating_polynomial, degree, canonical);
+  }
+  void Init(const Crc &generating_polynomial,
+            size_t degree,
+            bool canonical) {
+    if (generating_polynomial == FixedGeneratingPolynomial() &&
+        degree == FixedDegree()) {
+      Init(canonical);
+    }
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return 0x82f63b78; // 0x1edc6f41
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return 32;
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return base_; }
+
+  // Computes CRC32.
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    return Crc32c(data, bytes, crc);
+  }
+
+ protected:
+  // Actual implementation.
+  size_t Crc32c(const void *data, size_t bytes, Crc crc) const;
+
+  // Multiplies "crc" by x**(8 * kStripeBytes[size]) mod P.
+  Crc MultiplyCrc(size_t size, Crc crc) const;
+
+  enum {
+    kNumStripes = 3,
+
+    // Number of supported stripe sizes, see kStripeBytes in .cpp file.
+    // Like the block sizes of Crc32cSSE4 they are not powers of 2, so
+    // that common message sizes leave only a short tail for the
+    // single chain. Merging costs about as much as CRC'ing 64 bytes
+    // in a single chain, so stripes of 160 bytes still gain.
+    kNumStripeSizes = 4,
+
+    kTableEntryBits = 8,
+    kTableEntries = 1 << kTableEntryBits,
+    kNumTables = 32 / kTableEntryBits,
+  };
+
+  typedef uint32 Entry;
+
+  // Stripe sizes in bytes, largest first.
+  static const size_t kStripeBytes[kNumStripeSizes];
+
+  // For each stripe size S: products of every byte value at every byte
+  // position of a CRC with (x**(8 * S) mod P), used to move the CRC of
+  // a stripe to the end of the next one.
+  Entry mul_table_[kNumStripeSizes][kNumTables][kTableEntries];
+
+  GfUtil<Crc> base_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_INTERLEAVED_H_
@@ -0,0 +1,35 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of mostly zero data without CRC'ing the zeroes.
+
+#include "crc32c_sparse.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+size_t Crc32cSparse::CrcExtents(const void *data, size_t bytes,
+                                const Extent *extents, size_t count,
+                                const Crc &crc) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  uint64 offset = 0;
+  Crc result = crc;
+  for (size_t i = 0; i < count; ++i) {
+    const Extent &extent = extents[i];
+    if (extent.offset > offset) {
+      result = Base().CrcOfZeroes(extent.offset - offset, result);
+    }
+    result = crc_.CrcDefault(src + extent.offset,
+                             static_cast<size_t>(extent.bytes), result);
+    offset = extent.offset + extent.bytes;
+  }
+  if (bytes > offset) {
+    result = Base().CrcOfZeroes(bytes - offset, result);
+  }
+  return result;
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
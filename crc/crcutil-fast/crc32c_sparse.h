@@ -0,0 +1,88 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Computes CRC32C of mostly zero data, e.g. disk or memory snapshots,
+// without CRC'ing the zeroes.
+//
+// CRC of N zero bytes following a message with CRC "crc" is
+// crc * x**(8*N) mod P, which GfUtil::CrcOfZeroes() computes with
+// O(log N) multiplications. CrcExtents() does not look at the zeroes
+// at all: the caller supplies the non-zero extents (e.g. from the
+// allocation bitmap of an image), the extents are CRC'ed by the
+// Crc32cSSE4 code, and all bytes outside of them are assumed to be zero.
+//
+// Finding the zeroes by scanning the data is not offered: Crc32cSSE4
+// runs at about the speed of reading the data, so the scan alone costs
+// as much as CRC'ing everything.
+
+#ifndef CRCUTIL_CRC32C_SPARSE_H_
+#define CRCUTIL_CRC32C_SPARSE_H_
+
+#include "crc32c_sse4.h"          // Crc32cSSE4
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc32cSparse {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef size_t Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  // Region of "bytes" bytes at "offset" which may contain non-zero bytes.
+  struct Extent {
+    uint64 offset;
+    uint64 bytes;
+  };
+
+  Crc32cSparse() {}
+
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  explicit Crc32cSparse(bool canonical) {
+    Init(canonical);
+  }
+  void Init(bool canonical) {
+    crc_.Init(canonical);
+  }
+
+  // Returns fixed generating polymonial the class implements.
+  static Crc FixedGeneratingPolynomial() {
+    return Crc32cSSE4::FixedGeneratingPolynomial();
+  }
+
+  // Returns degree of fixed generating polymonial the class implements.
+  static Crc FixedDegree() {
+    return Crc32cSSE4::FixedDegree();
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return crc_.Base(); }
+
+  // Computes CRC32 of every byte (dense).
+  size_t CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    return crc_.CrcDefault(data, bytes, crc);
+  }
+
+  // Computes CRC32 of "bytes" bytes of which only the "count" extents
+  // may be non-zero. Extents must be sorted by offset, must not overlap,
+  // and must lie within "bytes"; the bytes outside of them are not read.
+  size_t CrcExtents(const void *data, size_t bytes,
+                    const Extent *extents, size_t count,
+                    const Crc &crc) const;
+
+ protected:
+  Crc32cSSE4 crc_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC32C_SPARSE_H_
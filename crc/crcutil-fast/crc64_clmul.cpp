@@ -0,0 +1,167 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements bit-reflected 64-bit CRCs using carry-less
+// multiplication (PCLMULQDQ).
+
+#include "crc64_clmul.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#include <wmmintrin.h>    // _mm_clmulepi64_si128
+
+namespace crcutil {
+
+// Multiplies low and high halves of "x" by respective halves of "k"
+// thus moving "x" forward by the distance encoded in "k",
+// and adds (XORs) the result to "data".
+static inline GCC_TARGET_ATTRIBUTE("sse4.1,pclmul")
+__m128i Fold128(__m128i x, __m128i k, __m128i data) {
+  __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+  __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+  return _mm_xor_si128(_mm_xor_si128(lo, hi), data);
+}
+
+#define LOAD_128(src, index) \
+  _mm_loadu_si128(reinterpret_cast<const __m128i *>(src) + (index))
+
+GCC_TARGET_ATTRIBUTE("sse4.1,pclmul")
+Crc64Clmul::Crc Crc64Clmul::Fold(const uint8 *src, size_t bytes,
+                                 Crc crc, const Constants &constants) {
+  __m128i x0 = LOAD_128(src, 0);
+  __m128i x1 = LOAD_128(src, 1);
+  __m128i x2 = LOAD_128(src, 2);
+  __m128i x3 = LOAD_128(src, 3);
+  x0 = _mm_xor_si128(x0,
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&crc)));
+  src += kFoldBytes;
+  bytes -= kFoldBytes;
+
+  // Fold 4 x 128 bits at a time.
+  __m128i k = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(constants.fold_4x128));
+  while (bytes >= kFoldBytes) {
+    x0 = Fold128(x0, k, LOAD_128(src, 0));
+    x1 = Fold128(x1, k, LOAD_128(src, 1));
+    x2 = Fold128(x2, k, LOAD_128(src, 2));
+    x3 = Fold128(x3, k, LOAD_128(src, 3));
+    src += kFoldBytes;
+    bytes -= kFoldBytes;
+  }
+
+  // Fold 4 accumulators into one, then process remaining 128-bit words.
+  k = _mm_loadu_si128(
+      reinterpret_cast<const __m128i *>(constants.fold_1x128));
+  x0 = Fold128(x0, k, x1);
+  x0 = Fold128(x0, k, x2);
+  x0 = Fold128(x0, k, x3);
+  while (bytes >= sizeof(__m128i)) {
+    x0 = Fold128(x0, k, LOAD_128(src, 0));
+    src += sizeof(__m128i);
+    bytes -= sizeof(__m128i);
+  }
+
+  // The CRC is (L * x**128 + H * x**64) mod P, where L and H are the
+  // low and high halves of the accumulator. Fold L onto H, which
+  // leaves 128 bits T = A * x**64 + B to be reduced.
+  k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(constants.fold_64));
+  x1 = _mm_clmulepi64_si128(x0, k, 0x00);
+  x0 = _mm_xor_si128(_mm_srli_si128(x0, 8), x1);
+
+  // Barrett reduction of 128 bits to 64 bits: with mu = x**64 + mu' and
+  // P = x**64 + P', the quotient is q = A + floor(A * mu' / x**64) and
+  // the remainder is B + ((q * P') mod x**64). In bit-reflected order,
+  // the product of two 64-bit values is off by one bit, hence the shifts.
+  k = _mm_loadu_si128(reinterpret_cast<const __m128i *>(constants.barrett));
+  x1 = _mm_clmulepi64_si128(x0, k, 0x00);
+  x1 = _mm_xor_si128(_mm_slli_epi64(x1, 1), x0);
+  x1 = _mm_clmulepi64_si128(x1, k, 0x10);
+  x0 = _mm_xor_si128(x0, _mm_slli_epi64(x1, 1));
+  x0 = _mm_xor_si128(x0, _mm_slli_si128(_mm_srli_epi64(x1, 63), 8));
+
+  uint64 result[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(result), x0);
+  return result[1];
+}
+
+#undef LOAD_128
+
+Crc64Clmul::Crc Crc64Clmul::Crc64(const void *data, size_t bytes,
+                                  Crc crc) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  const uint8 *end = src + bytes;
+  crc ^= Base().Canonize();
+
+  if (bytes >= kMinFoldBytes) {
+    size_t fold_bytes = bytes & ~static_cast<size_t>(sizeof(__m128i) - 1);
+    crc = Fold(src, fold_bytes, crc, k_);
+    src += fold_bytes;
+  }
+
+  // Finish the tail byte-by-byte.
+  while (src < end) {
+    crc = crc_byte_[static_cast<uint8>(crc ^ src[0])] ^ (crc >> 8);
+    src += 1;
+  }
+
+  return (crc ^ Base().Canonize());
+}
+
+
+void Crc64Clmul::Init(const Crc &generating_polynomial,
+                      size_t degree,
+                      bool canonical) {
+  base_.Init(generating_polynomial, degree, canonical);
+
+  // GfUtil<uint64> of degree 64 keeps x**0 in the most significant bit,
+  // which is exactly the bit-reflected order PCLMULQDQ operates on.
+  // The bit-reflected P * x**(64-degree) is the same as that of P.
+  GfUtil<Crc> gf(generating_polynomial, 64, false);
+  k_.fold_4x128[0] = gf.XpowN(4 * 128 + 63);
+  k_.fold_4x128[1] = gf.XpowN(4 * 128 - 1);
+  k_.fold_1x128[0] = gf.XpowN(128 + 63);
+  k_.fold_1x128[1] = gf.XpowN(128 - 1);
+  k_.fold_64[0] = gf.XpowN(127);
+  k_.fold_64[1] = 0;
+
+  // Compute floor(x**128 / P) by long division in normal (non-reflected)
+  // bit order. The leading x**64 of the quotient is shifted out, which
+  // leaves mu'. Then reflect it.
+  uint64 poly = 0;
+  for (size_t i = 0; i < 64; ++i) {
+    if ((generating_polynomial >> i) & 1) {
+      poly |= static_cast<uint64>(1) << (63 - i);
+    }
+  }
+  uint64 remainder = poly;
+  uint64 quotient = 1;
+  for (size_t i = 0; i < 64; ++i) {
+    uint64 carry = remainder >> 63;
+    remainder <<= 1;
+    quotient <<= 1;
+    if (carry != 0) {
+      remainder ^= poly;
+      quotient |= 1;
+    }
+  }
+  uint64 mu = 0;
+  for (size_t i = 0; i < 64; ++i) {
+    if ((quotient >> i) & 1) {
+      mu |= static_cast<uint64>(1) << (63 - i);
+    }
+  }
+  k_.barrett[0] = mu;
+  k_.barrett[1] = generating_polynomial;
+
+  for (size_t i = 0; i < 256; ++i) {
+    Crc value = static_cast<Crc>(i);
+    for (size_t bit = 0; bit < 8; ++bit) {
+      value = (value >> 1) ^ ((value & 1) != 0 ? generating_polynomial : 0);
+    }
+    crc_byte_[i] = value;
+  }
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
@@ -0,0 +1,131 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements bit-reflected 64-bit CRCs (e.g. CRC-64/ECMA-182 as used
+// by xz, or the CRC-64 of NVMe end-to-end data protection) using
+// carry-less multiplication (PCLMULQDQ).
+//
+// Folding works the same way as in Crc32cClmul: 4 x 128-bit
+// accumulators, 64 bytes per iteration, folded into a single 128-bit
+// value at the end. Because the CRC is as wide as a PCLMULQDQ operand,
+// the folding constants are (x**n mod P) for n = distance + 63 and
+// distance - 1, and the final reduction of 128 to 64 bits uses a
+// 65-bit Barrett constant with its leading term handled explicitly.
+//
+// A bit-reflected CRC of degree D < 64 with polynomial P equals the
+// 64-bit CRC with polynomial P * x**(64-D), and the bit-reflected
+// representation of both polynomials is the same. Hence the same kernel
+// serves any polynomial of degree up to 64; only the constants differ.
+//
+// There is no crc32-like instruction for 64-bit CRCs, so short inputs
+// and the last (less than 16) bytes are processed using a byte table.
+//
+// The class mimics the interface of GenericCrc<uint64, uint64, uint64, 4>
+// and may be used wherever the latter is used for reflected polynomials.
+
+#ifndef CRCUTIL_CRC64_CLMUL_H_
+#define CRCUTIL_CRC64_CLMUL_H_
+
+#include "crc32c_clmul.h"         // Crc32cClmul::IsClmulAvailable()
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class Crc64Clmul {
+ public:
+  // Exports Crc, TableEntry, and Word (needed by RollingCrc).
+  typedef uint64 Crc;
+  typedef Crc Word;
+  typedef Crc TableEntry;
+
+  Crc64Clmul() {}
+
+  // Initializes folding constants and the byte table given bit-reflected
+  // generating polynomial of degree (degree), at most 64.
+  // If "canonical" is true, crc value will be XOR'ed with (-1) before and
+  // after actual CRC computation.
+  Crc64Clmul(const Crc &generating_polynomial,
+             size_t degree,
+             bool canonical) {
+    Init(generating_polynomial, degree, canonical);
+  }
+  void Init(const Crc &generating_polynomial,
+            size_t degree,
+            bool canonical);
+
+  // Returns bit-reflected ECMA-182 polynomial (CRC-64/XZ).
+  static Crc Ecma182Polynomial() {
+    return 0xc96c5795d7870f42ULL; // 0x42f0e1eba9ea3693
+  }
+
+  // Returns bit-reflected polynomial of NVMe end-to-end data protection.
+  static Crc NvmePolynomial() {
+    return 0x9a6c9329ac4bc9b5ULL; // 0xad93d23594c93659
+  }
+
+  // Returns base class.
+  const GfUtil<Crc> &Base() const { return base_; }
+
+  // Computes CRC64.
+  Crc CrcDefault(const void *data, size_t bytes, const Crc &crc) const {
+    return Crc64(data, bytes, crc);
+  }
+
+  // Returns true iff pclmulqdq instruction (and SSE4) is available.
+  static bool IsClmulAvailable() {
+    return Crc32cClmul::IsClmulAvailable();
+  }
+
+  // Folding and reduction constants of the 64-bit polynomial P,
+  // i.e. of the actual polynomial multiplied by x**(64-degree).
+  struct Constants {
+    // Bit-reflected (x**n mod P), where n is the folding distance
+    // in bits + 63 and - 1, respectively.
+    uint64 fold_4x128[2];
+    uint64 fold_1x128[2];
+
+    // Bit-reflected (x**127 mod P) to fold 128 bits to 64 bits.
+    uint64 fold_64[2];
+
+    // Bit-reflected floor(x**128 / P) and generating polynomial,
+    // both without their leading x**64 term, used by Barrett reduction.
+    uint64 barrett[2];
+  };
+
+  enum {
+    kFoldBytes = 4 * 16,
+
+    // Below this size, the byte table is faster than loading the
+    // constants and reducing the accumulators.
+    kMinFoldBytes = kFoldBytes,
+  };
+
+  // Folds "bytes" bytes starting at "src" and returns the resulting
+  // (non-canonized) CRC. "bytes" shall be a multiple of 16 and
+  // shall not be less than kFoldBytes. The caller shall make sure
+  // that pclmulqdq instruction is available.
+  // Exported so that constants computed elsewhere (e.g. at compile
+  // time) may be used with the same kernel.
+  static Crc Fold(const uint8 *src, size_t bytes, Crc crc,
+                  const Constants &k);
+
+ protected:
+  // Actual implementation.
+  Crc Crc64(const void *data, size_t bytes, Crc crc) const;
+
+  Constants k_;
+  Crc crc_byte_[256];
+
+  GfUtil<Crc> base_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_CRC64_CLMUL_H_
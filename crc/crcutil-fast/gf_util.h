@@ -110,6 +110,42 @@ template<typename Crc> class GfUtil {
     return (tmp ^ this->canonize_);
   }
 
+  // Returns CRC of a message of "total_bytes" bytes after "bytes" bytes
+  // at "offset" were overwritten -- touching only the changed bytes.
+  //
+  // To be precise, given crc=CRC(M, |M|, start), returns CRC(M', |M|, start)
+  // where M' is M with old_bytes[0..bytes-1] replaced by new_bytes[...].
+  // CRC is linear, so CRC(M') = CRC(M) ^ CRC(M ^ M', 0, non-canonical),
+  // and M ^ M' is zero but for the patched region. Costs O(bytes)
+  // bit operations plus O(log(total_bytes)) multiplications.
+  //
+  // Requires offset + bytes <= total_bytes: otherwise the number of
+  // bytes after the patched region wraps around and the result is
+  // garbage. Not checked, like the lengths passed to CrcDefault().
+  Crc ReplaceBytes(const Crc &crc, uint64 total_bytes, uint64 offset,
+                   const void *old_bytes, const void *new_bytes,
+                   size_t bytes) const {
+    const uint8 *o = reinterpret_cast<const uint8 *>(old_bytes);
+    const uint8 *n = reinterpret_cast<const uint8 *>(new_bytes);
+    Crc delta_crc = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+      delta_crc ^= static_cast<Crc>(o[i] ^ n[i]);
+      for (size_t bit = 0; bit < 8; ++bit) {
+        delta_crc = (delta_crc >> 1) ^
+            this->normalize_[Downcast<Crc, size_t>(delta_crc & 1)];
+      }
+    }
+    return ApplyDelta(crc, delta_crc, total_bytes - offset - bytes);
+  }
+
+  // Same as above when delta_crc=CRC(D, |D|, 0) of D = old ^ new bytes
+  // is known, e.g. computed by a faster non-canonical CRC implementation,
+  // and "bytes_after" bytes follow the patched region.
+  Crc ApplyDelta(const Crc &crc, const Crc &delta_crc,
+                 uint64 bytes_after) const {
+    return (crc ^ Multiply(delta_crc, Xpow8N(bytes_after)));
+  }
+
   // Given CRC of a message, stores extra (degree + 7)/8 bytes after
   // the message so that CRC(message+extra, start) = result.
   // Does not change CRC start value (use ChangeStartValue for that).
@@ -197,6 +197,13 @@
 // For 128-bit SSE2, the penalty is access violation.
 #define GCC_ALIGN_ATTRIBUTE(n) __attribute__((aligned(n)))
 
+#if GCC_VERSION_AVAILABLE(4, 9)
+// Allows to compile individual functions for instruction set extensions
+// (PCLMULQDQ, AVX-512, etc.) which are not enabled on the command line.
+// The caller is responsible for checking CPU support at runtime.
+#define GCC_TARGET_ATTRIBUTE(isa) __attribute__((__target__(isa)))
+#endif  // GCC_VERSION_AVAILABLE(4, 9)
+
 #if GCC_VERSION_AVAILABLE(4, 4)
 // If not marked as "omit frame pointer",
 // GCC won't be able to find enough registers.
@@ -241,5 +248,9 @@
 #define GCC_ALIGN_ATTRIBUTE(n)
 #endif  // !defined(GCC_ALIGN_ATTRIBUTE)
 
+#if !defined(GCC_TARGET_ATTRIBUTE)
+#define GCC_TARGET_ATTRIBUTE(isa)
+#endif  // !defined(GCC_TARGET_ATTRIBUTE)
+
 
 #endif  // CRCUTIL_PLATFORM_H_
@@ -50,7 +50,7 @@ template<typename CrcImplementation> class ProtectedCrc
   // 3. Worst case, every Nth CRC'ed byte or every Nth call to CRC.
   //
   Crc SelfCheckValue() const {
-    return CrcDefault(this, sizeof(*this), 0);
+    return this->CrcDefault(this, sizeof(*this), 0);
   }
 } GCC_ALIGN_ATTRIBUTE(16);
 
@@ -0,0 +1,176 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements rolling CRC32C evaluating 32 windows at once (AVX2).
+
+#include "rolling_crc32c_avx2.h"
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#if CRCUTIL_USE_AVX2
+#include <immintrin.h>    // _mm256_i32gather_epi32 etc.
+#endif  // CRCUTIL_USE_AVX2
+
+namespace crcutil {
+
+#if CRCUTIL_USE_AVX2
+
+// Number of independent 8-lane registers (kLanes / 8). Every step of a
+// lane waits for the gathers of the previous one; several registers
+// keep enough gathers in flight to hide their latency.
+static const int kAvx2Registers = 4;
+
+// Scans 8 * kAvx2Registers * lane_bytes positions starting at "pos";
+// lane i covers [pos + i * lane_bytes, pos + (i + 1) * lane_bytes) and
+// starts with crcs[i]. Writes lane_bytes / 64 bitmap entries per lane.
+static GCC_TARGET_ATTRIBUTE("avx2")
+void ScanAvx2(const uint8 *data, size_t pos, size_t lane_bytes,
+              size_t window, const uint32 *in, const uint32 *out,
+              uint32 mask, const uint32 *crcs, uint64 *bitmap) {
+  const int stride = static_cast<int>(lane_bytes);
+  const __m256i lanes = _mm256_setr_epi32(0 * stride, 1 * stride,
+                                          2 * stride, 3 * stride,
+                                          4 * stride, 5 * stride,
+                                          6 * stride, 7 * stride);
+  const __m256i mask8 = _mm256_set1_epi32(mask);
+  const __m256i ff = _mm256_set1_epi32(0xff);
+  __m256i crc[kAvx2Registers];
+  for (int r = 0; r < kAvx2Registers; ++r) {
+    crc[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(crcs) + r);
+  }
+
+  uint8 masks[kAvx2Registers][64];
+  for (size_t k = 0; k < lane_bytes; k += 64) {
+    for (size_t s = 0; s < 64; s += 4) {
+      __m256i byte_in[kAvx2Registers];
+      __m256i byte_out[kAvx2Registers];
+      for (int r = 0; r < kAvx2Registers; ++r) {
+        const uint8 *src = data + pos + k + s + 8 * r * lane_bytes;
+        byte_in[r] = _mm256_i32gather_epi32(
+            reinterpret_cast<const int *>(src), lanes, 1);
+        byte_out[r] = _mm256_i32gather_epi32(
+            reinterpret_cast<const int *>(src - window), lanes, 1);
+      }
+      for (size_t t = 0; t < 4; ++t) {
+        for (int r = 0; r < kAvx2Registers; ++r) {
+          masks[r][s + t] = static_cast<uint8>(_mm256_movemask_ps(
+              _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+                  _mm256_and_si256(crc[r], mask8), mask8))));
+          const __m256i i =
+              _mm256_and_si256(_mm256_xor_si256(crc[r], byte_in[r]), ff);
+          const __m256i o = _mm256_and_si256(byte_out[r], ff);
+          crc[r] = _mm256_xor_si256(_mm256_srli_epi32(crc[r], 8),
+              _mm256_xor_si256(
+                  _mm256_i32gather_epi32(
+                      reinterpret_cast<const int *>(in), i, 4),
+                  _mm256_i32gather_epi32(
+                      reinterpret_cast<const int *>(out), o, 4)));
+          byte_in[r] = _mm256_srli_epi32(byte_in[r], 8);
+          byte_out[r] = _mm256_srli_epi32(byte_out[r], 8);
+        }
+      }
+    }
+
+    // masks[r][s] holds one bit per lane; transpose into one 64-bit
+    // bitmap entry per lane by moving bit "lane" of every byte into
+    // its MSB.
+    for (int r = 0; r < kAvx2Registers; ++r) {
+      const __m256i m0 =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(masks[r]));
+      const __m256i m1 = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(masks[r] + 32));
+      for (int lane = 0; lane < 8; ++lane) {
+        const __m128i shift = _mm_cvtsi32_si128(7 - lane);
+        const uint32 lo = static_cast<uint32>(_mm256_movemask_epi8(
+            _mm256_sll_epi64(m0, shift)));
+        const uint32 hi = static_cast<uint32>(_mm256_movemask_epi8(
+            _mm256_sll_epi64(m1, shift)));
+        bitmap[((8 * r + lane) * lane_bytes + k) / 64] =
+            static_cast<uint64>(lo) | (static_cast<uint64>(hi) << 32);
+      }
+    }
+  }
+}
+
+#endif  // CRCUTIL_USE_AVX2
+
+void RollingCrc32cAvx2::FindCandidates(const void *data, size_t first,
+                                       size_t last, const Crc &mask,
+                                       uint64 *bitmap) const {
+  const uint8 *src = static_cast<const uint8 *>(data);
+  size_t pos = first;
+#if CRCUTIL_USE_AVX2
+  while (last - pos >= kLanes * kBitsPerWord) {
+    size_t lane_bytes = (last - pos) / kLanes;
+    if (lane_bytes > kMaxLaneBytes) {
+      lane_bytes = kMaxLaneBytes;
+    }
+    lane_bytes &= ~static_cast<size_t>(kBitsPerWord - 1);
+    uint32 crcs[kLanes];
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      crcs[lane] = static_cast<uint32>(
+          Start(src + pos + lane * lane_bytes - roll_window_bytes_));
+    }
+    ScanAvx2(src, pos, lane_bytes, roll_window_bytes_, in_, out_,
+             static_cast<uint32>(mask), crcs,
+             bitmap + (pos - first) / kBitsPerWord);
+    pos += kLanes * lane_bytes;
+  }
+#endif  // CRCUTIL_USE_AVX2
+  // "pos - first" is a multiple of kBitsPerWord here.
+  FindCandidatesScalar(data, pos, last, mask,
+                       bitmap + (pos - first) / kBitsPerWord);
+}
+
+void RollingCrc32cAvx2::FindCandidatesScalar(const void *data, size_t first,
+                                             size_t last, const Crc &mask,
+                                             uint64 *bitmap) const {
+  if (first >= last) {
+    return;
+  }
+  const uint8 *src = static_cast<const uint8 *>(data);
+  memset(bitmap, 0, (last - first + kBitsPerWord - 1) / kBitsPerWord *
+         sizeof(bitmap[0]));
+  Crc crc = Start(src + first - roll_window_bytes_);
+  for (size_t p = first; ; ++p) {
+    if ((crc & mask) == mask) {
+      bitmap[(p - first) / kBitsPerWord] |=
+          static_cast<uint64>(1) << ((p - first) % kBitsPerWord);
+    }
+    if (p + 1 >= last) {
+      break;
+    }
+    crc = Roll(crc, src[p - roll_window_bytes_], src[p]);
+  }
+}
+
+void RollingCrc32cAvx2::Init(const Crc32cSSE4 &crc,
+                             size_t roll_window_bytes,
+                             const Crc &start_value) {
+  crc_ = &crc;
+  roll_window_bytes_ = roll_window_bytes;
+  start_value_ = start_value;
+
+  // Same as RollingCrc32cSSE4::Init().
+  Crc add = crc.Base().Canonize() ^ start_value;
+  add = crc.Base().Multiply(add, crc.Base().Xpow8N(roll_window_bytes));
+  add ^= crc.Base().Canonize();
+  Crc mul = crc.Base().One() ^ crc.Base().Xpow8N(1);
+  add = crc.Base().Multiply(add, mul);
+
+  mul = crc.Base().XpowN(8 * roll_window_bytes + crc.Base().Degree());
+  for (size_t i = 0; i < 256; ++i) {
+    out_[i] = static_cast<uint32>(
+                  crc.Base().MultiplyUnnormalized(
+                      static_cast<Crc>(i), 8, mul) ^ add);
+  }
+
+  // crc32 instruction on a single byte, as a table.
+  for (size_t i = 0; i < 256; ++i) {
+    in_[i] = _mm_crc32_u8(0, static_cast<uint8>(i));
+  }
+}
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
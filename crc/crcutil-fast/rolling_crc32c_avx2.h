@@ -0,0 +1,123 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Implements rolling CRC32C evaluating 32 windows at once (AVX2).
+//
+// RollingCrc32cSSE4::Roll() depends on the result of the previous step,
+// so a single scan cannot go faster than the latency of one crc32
+// instruction plus one table lookup per byte. FindCandidates() instead
+// splits the scanned range into kLanes lanes and rolls one window per
+// lane in the 32-bit elements of four AVX2 registers. Input and output
+// bytes of four consecutive steps are fetched with one gather per
+// register; the table lookups are gathers as well.
+//
+// Positions whose window CRC has all bits of "mask" set (candidates for
+// content-defined chunk boundaries) are reported in a bitmap.
+
+#ifndef CRCUTIL_ROLLING_CRC32C_AVX2_H_
+#define CRCUTIL_ROLLING_CRC32C_AVX2_H_
+
+#include "crc32c_sse4.h"          // Crc32cSSE4
+
+#if CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+// AVX2 intrinsics with __target__ attribute are available since GCC 4.9
+// and Visual Studio 2012.
+#if !defined(CRCUTIL_USE_AVX2)
+#if GCC_VERSION_AVAILABLE(4, 9) || (defined(_MSC_VER) && _MSC_VER >= 1700)
+#define CRCUTIL_USE_AVX2 1
+#else
+#define CRCUTIL_USE_AVX2 0
+#endif
+#endif  // !defined(CRCUTIL_USE_AVX2)
+
+namespace crcutil {
+
+#pragma pack(push, 16)
+
+class RollingCrc32cAvx2 {
+ public:
+  typedef Crc32cSSE4::Crc Crc;
+  typedef Crc32cSSE4::TableEntry TableEntry;
+  typedef Crc32cSSE4::Word Word;
+
+  RollingCrc32cAvx2() {}
+
+  // Initializes internal data structures.
+  // Retains reference to "crc" instance -- it is used by Start().
+  RollingCrc32cAvx2(const Crc32cSSE4 &crc,
+                    size_t roll_window_bytes,
+                    const Crc &start_value) {
+    Init(crc, roll_window_bytes, start_value);
+  }
+  void Init(const Crc32cSSE4 &crc,
+            size_t roll_window_bytes,
+            const Crc &start_value);
+
+  // Computes crc of "roll_window_bytes" using
+  // "start_value" of "crc" (see Init()).
+  Crc Start(const void *data) const {
+    return crc_->CrcDefault(data, roll_window_bytes_, start_value_);
+  }
+
+  // Computes CRC of "roll_window_bytes" starting in next position.
+  Crc Roll(const Crc &old_crc, size_t byte_out, size_t byte_in) const {
+    return (old_crc >> 8) ^ in_[TO_BYTE(old_crc) ^ byte_in] ^ out_[byte_out];
+  }
+
+  // For every position p in [first, last) checks whether the CRC of the
+  // window ending at p, i.e. of data[p - WindowBytes()..p - 1], has all
+  // bits of "mask" set. If so, sets bit (p - first) of "bitmap"
+  // (bit i is bit (i % 64) of bitmap[i / 64]), otherwise clears it.
+  // "bitmap" shall hold at least (last - first + 63) / 64 entries.
+  // "first" shall not be less than WindowBytes().
+  //
+  // Uses AVX2 if compiled in (see HasAvx2Backend()); the caller has to
+  // make sure the CPU supports it. Short ranges are scanned with Roll().
+  void FindCandidates(const void *data, size_t first, size_t last,
+                      const Crc &mask, uint64 *bitmap) const;
+
+  // Same as above, using Roll() only.
+  void FindCandidatesScalar(const void *data, size_t first, size_t last,
+                            const Crc &mask, uint64 *bitmap) const;
+
+  // Returns true iff the AVX2 code path was compiled in.
+  static bool HasAvx2Backend() {
+    return (CRCUTIL_USE_AVX2 != 0);
+  }
+
+  // Returns start value.
+  Crc StartValue() const { return start_value_; }
+
+  // Returns length of roll window.
+  size_t WindowBytes() const { return roll_window_bytes_; }
+
+ protected:
+  enum {
+    // Four AVX2 registers of eight 32-bit lanes each.
+    kLanes = 32,
+
+    // Lane length is a multiple of kBitsPerWord so that every lane
+    // writes whole bitmap entries. Longer lanes are split into several
+    // blocks to keep the eight input streams close to each other.
+    kBitsPerWord = 64,
+    kMaxLaneBytes = 4 * 1024,
+  };
+
+  // 32-bit entries: gathers load 32-bit elements.
+  uint32 in_[256];
+  uint32 out_[256];
+
+  // Used only by Start().
+  Crc start_value_;
+  const Crc32cSSE4 *crc_;
+  size_t roll_window_bytes_;
+} GCC_ALIGN_ATTRIBUTE(16);
+
+#pragma pack(pop)
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_USE_MM_CRC32 && (HAVE_I386 || HAVE_AMD64)
+
+#endif  // CRCUTIL_ROLLING_CRC32C_AVX2_H_
@@ -0,0 +1,141 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+// Runs ProtectedCrc::SelfCheckValue() automatically, amortized over the
+// data being CRC'ed.
+//
+// For every "bytes_per_check" bytes passed to CrcDefault(), the CRC
+// tables (i.e. the entire ProtectedCrc object) are CRC'ed once and the
+// result is compared against the trusted check value. The self-check
+// is split into slices of "slice_bytes" bytes. Each call to CrcDefault()
+// runs only the slices its own data has paid for, so every call becomes
+// slower by the same small fraction, and a short call never pays for
+// a full self-check.
+// Overhead is sizeof(ProtectedCrc) / bytes_per_check, e.g. 3% for
+// the 33 KB of ProtectedCrc<GenericCrc<uint64, uint64, uint64, 4> > and
+// one check per megabyte.
+//
+// Unlike CRC implementations, SelfCheckingCrc is not stateless:
+// use one instance per thread.
+
+#ifndef CRCUTIL_SELF_CHECKING_CRC_H_
+#define CRCUTIL_SELF_CHECKING_CRC_H_
+
+#include "base_types.h"       // uint8, uint64
+#include "platform.h"         // GCC_ALIGN_ATTRIBUTE
+#include "protected_crc.h"    // ProtectedCrc
+
+namespace crcutil {
+
+template<typename CrcImplementation> class SelfCheckingCrc {
+ public:
+  typedef typename CrcImplementation::Crc Crc;
+  typedef ProtectedCrc<CrcImplementation> Protected;
+
+  enum {
+    kDefaultBytesPerCheck = 1 << 20,
+    kDefaultSliceBytes = 256,
+  };
+
+  // "check_value" is the trusted value of crc.SelfCheckValue(),
+  // e.g. a constant computed on a known good machine.
+  SelfCheckingCrc(const Protected &crc, const Crc &check_value,
+                  uint64 bytes_per_check = kDefaultBytesPerCheck,
+                  size_t slice_bytes = kDefaultSliceBytes)
+      : crc_(crc),
+        check_value_(check_value),
+        slice_bytes_(slice_bytes != 0 ? slice_bytes : 1),
+        position_(0),
+        partial_(0),
+        debt_(0),
+        checks_(0),
+        failures_(0),
+        slices_(0),
+        last_check_failed_(false) {
+    // Spread one self-check over bytes_per_check bytes of data.
+    uint64 slices_per_check =
+        (sizeof(Protected) + slice_bytes_ - 1) / slice_bytes_;
+    bytes_per_slice_ = bytes_per_check / slices_per_check;
+    if (bytes_per_slice_ == 0) {
+      bytes_per_slice_ = 1;
+    }
+  }
+
+  const Protected &Impl() const { return crc_; }
+  const GfUtil<Crc> &Base() const { return crc_.Base(); }
+
+  // Computes CRC of the data, then runs as many slices of the
+  // self-check as the data has paid for.
+  Crc CrcDefault(const void *data, size_t bytes, const Crc &start) {
+    Crc crc = crc_.CrcDefault(data, bytes, start);
+    debt_ += bytes;
+    while (debt_ >= bytes_per_slice_) {
+      debt_ -= bytes_per_slice_;
+      CheckSlice();
+    }
+    return crc;
+  }
+
+  // Runs a complete self-check right away, e.g. on CRC mismatch.
+  // Restarts the amortized check. Returns true iff the tables are intact.
+  bool CheckNow() {
+    position_ = 0;
+    partial_ = 0;
+    while (!CheckSlice()) {
+    }
+    return !last_check_failed_;
+  }
+
+  // Number of completed self-checks.
+  uint64 Checks() const { return checks_; }
+
+  // Number of self-checks which did not match the check value.
+  uint64 Failures() const { return failures_; }
+
+  // Number of slices run.
+  uint64 Slices() const { return slices_; }
+
+  // Returns true iff the most recently completed self-check failed.
+  bool LastCheckFailed() const { return last_check_failed_; }
+
+ private:
+  // CRCs the next slice of the protected object.
+  // Returns true iff it was the last one.
+  bool CheckSlice() {
+    const uint8 *object = reinterpret_cast<const uint8 *>(&crc_);
+    size_t bytes = sizeof(Protected) - position_;
+    if (bytes > slice_bytes_) {
+      bytes = slice_bytes_;
+    }
+    partial_ = crc_.CrcDefault(object + position_, bytes, partial_);
+    position_ += bytes;
+    ++slices_;
+    if (position_ < sizeof(Protected)) {
+      return false;
+    }
+    ++checks_;
+    last_check_failed_ = (partial_ != check_value_);
+    if (last_check_failed_) {
+      ++failures_;
+    }
+    position_ = 0;
+    partial_ = 0;
+    return true;
+  }
+
+  const Protected &crc_;
+  const Crc check_value_;
+  const size_t slice_bytes_;
+  uint64 bytes_per_slice_;
+  size_t position_;
+  Crc partial_;
+  uint64 debt_;
+  uint64 checks_;
+  uint64 failures_;
+  uint64 slices_;
+  bool last_check_failed_;
+};
+
+}  // namespace crcutil
+
+#endif  // CRCUTIL_SELF_CHECKING_CRC_H_
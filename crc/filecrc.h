@@ -0,0 +1,347 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __FILECRC_H_
+#define __FILECRC_H_
+
+#if defined(WIN32)
+#include <Windows.h>
+#include "gnutypes.h"
+#elif defined(__GNUC__)
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#include <stddef.h>
+#include <string>
+
+
+// Berechnet den CRC einer Datei.
+//
+// Zum Vergleich stehen drei Verfahren bereit:
+//
+//  - read(): liest die Datei nur, ohne einen CRC zu berechnen, und
+//    liefert so die Referenz fuer die erreichbare I/O-Bandbreite.
+//  - readCrc(): ein eigener Thread liest die Datei blockweise
+//    abwechselnd in zwei Puffer (pread() bzw. ReadFile()), waehrend
+//    der aufrufende Thread den CRC des jeweils anderen Puffers bildet.
+//  - mapCrc(): blendet die Datei in den Adressraum ein (mmap() bzw.
+//    MapViewOfFile()) und teilt dem Betriebssystem mit, dass sie
+//    sequenziell gelesen wird (madvise(MADV_SEQUENTIAL)). Passt die
+//    Datei nicht in den Adressraum (32-Bit-Build, mehr als 4 GByte),
+//    schlaegt mapCrc() fehl; readCrc() funktioniert weiterhin.
+//
+// Damit alle Verfahren dieselben Bedingungen vorfinden, entfernt
+// dropCache() die Datei vor jedem Durchgang aus dem Dateicache.
+//
+// CRCIMPL ist eine Klasse aus crcutil-fast, die CrcDefault() anbietet.
+template <class CRCIMPL>
+class FileCrc {
+public:
+  typedef typename CRCIMPL::Crc Crc;
+
+  static const size_t DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+  FileCrc(const CRCIMPL& crcImpl, size_t chunkSize = DEFAULT_CHUNK_SIZE)
+    : mCrcImpl(crcImpl)
+    , mChunkSize(chunkSize)
+    , mSize(0)
+#if defined(WIN32)
+    , mFile(INVALID_HANDLE_VALUE)
+    , mMapping(NULL)
+#elif defined(__GNUC__)
+    , mFile(-1)
+#endif
+    , mMap(NULL)
+    , mMapSize(0)
+  {
+    mBuf[0] = new uint8_t[mChunkSize];
+    mBuf[1] = new uint8_t[mChunkSize];
+  }
+
+  ~FileCrc()
+  {
+    close();
+    delete [] mBuf[0];
+    delete [] mBuf[1];
+  }
+
+  bool open(const char* filename)
+  {
+    close();
+    mFilename = filename;
+#if defined(WIN32)
+    mFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+      return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size)) {
+      close();
+      return false;
+    }
+    mSize = (uint64_t)size.QuadPart;
+#elif defined(__GNUC__)
+    mFile = ::open(filename, O_RDONLY);
+    if (mFile < 0)
+      return false;
+    struct stat st;
+    if (fstat(mFile, &st) != 0) {
+      close();
+      return false;
+    }
+    mSize = (uint64_t)st.st_size;
+    posix_fadvise(mFile, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return true;
+  }
+
+  void close(void)
+  {
+    unmap();
+#if defined(WIN32)
+    if (mFile != INVALID_HANDLE_VALUE)
+      CloseHandle(mFile);
+    mFile = INVALID_HANDLE_VALUE;
+#elif defined(__GNUC__)
+    if (mFile >= 0)
+      ::close(mFile);
+    mFile = -1;
+#endif
+    mSize = 0;
+  }
+
+  inline uint64_t size(void) const
+  {
+    return mSize;
+  }
+
+  // Datei aus dem Dateicache entfernen, damit der naechste Durchgang
+  // wieder vom Datentraeger liest; eine eingeblendete Datei wird dazu
+  // ausgeblendet. Unter Windows leert das Oeffnen ohne Puffer
+  // (FILE_FLAG_NO_BUFFERING) den Cache, sofern kein anderes Handle die
+  // Datei gepuffert offen haelt; deshalb wird sie dafuer geschlossen.
+  bool dropCache(void)
+  {
+    unmap();
+#if defined(WIN32)
+    const std::string filename = mFilename;
+    close();
+    HANDLE hFile = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, NULL);
+    if (hFile != INVALID_HANDLE_VALUE)
+      CloseHandle(hFile);
+    return hFile != INVALID_HANDLE_VALUE && open(filename.c_str());
+#elif defined(__GNUC__)
+    return posix_fadvise(mFile, 0, 0, POSIX_FADV_DONTNEED) == 0;
+#endif
+  }
+
+  // Datei nur lesen
+  bool read(void)
+  {
+    for (uint64_t offset = 0; offset < mSize; ) {
+      int64_t bytesRead = readChunk(mBuf[0], offset);
+      if (bytesRead <= 0)
+        return false;
+      offset += bytesRead;
+    }
+    return true;
+  }
+
+  // Datei doppelt gepuffert lesen und CRC berechnen; liefert false bei
+  // Lesefehlern oder wenn der Lese-Thread nicht gestartet werden kann
+  bool readCrc(Crc& crc, const Crc& start)
+  {
+    mReadError = false;
+    mBytesRead[0] = mBytesRead[1] = 0;
+#if defined(WIN32)
+    mFree = CreateSemaphore(NULL, 2, 2, NULL);
+    mFull = CreateSemaphore(NULL, 0, 2, NULL);
+    HANDLE hThread = CreateThread(NULL, 0, ReaderThreadProc, (LPVOID)this, 0, NULL);
+    if (hThread == NULL) {
+      CloseHandle(mFree);
+      CloseHandle(mFull);
+      return false;
+    }
+#elif defined(__GNUC__)
+    sem_init(&mFree, 0, 2);
+    sem_init(&mFull, 0, 0);
+    pthread_t hThread;
+    if (pthread_create(&hThread, NULL, ReaderThreadProc, (void*)this) != 0) {
+      sem_destroy(&mFree);
+      sem_destroy(&mFull);
+      return false;
+    }
+#endif
+    crc = start;
+    for (int i = 0; ; i ^= 1) {
+      waitFor(mFull);
+      if (mBytesRead[i] <= 0)
+        break;
+      crc = mCrcImpl.CrcDefault(mBuf[i], (size_t)mBytesRead[i], crc);
+      signal(mFree);
+    }
+#if defined(WIN32)
+    WaitForSingleObject(hThread, INFINITE);
+    CloseHandle(hThread);
+    CloseHandle(mFree);
+    CloseHandle(mFull);
+#elif defined(__GNUC__)
+    pthread_join(hThread, NULL);
+    sem_destroy(&mFree);
+    sem_destroy(&mFull);
+#endif
+    return !mReadError;
+  }
+
+  // passt die Datei in einem Stueck in den Adressraum?
+  inline bool mappable(void) const
+  {
+    return mSize <= (uint64_t)(size_t)-1;
+  }
+
+  // Datei in den Speicher einblenden und CRC berechnen;
+  // liefert false, wenn das nicht geht (s. mappable())
+  bool mapCrc(Crc& crc, const Crc& start)
+  {
+    crc = start;
+    if (mSize == 0)
+      return true;
+    const uint8_t* data = map();
+    if (data == NULL)
+      return false;
+    crc = mCrcImpl.CrcDefault(data, mMapSize, crc);
+    unmap();
+    return true;
+  }
+
+  // Datei fuer sequenzielles Lesen in den Speicher einblenden;
+  // liefert NULL bei Fehlern, wenn die Datei leer ist oder nicht
+  // in den Adressraum passt
+  const uint8_t* map(void)
+  {
+    unmap();
+    if (mSize == 0 || !mappable())
+      return NULL;
+    const size_t bytes = (size_t)mSize;
+#if defined(WIN32)
+    mMapping = CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mMapping == NULL)
+      return NULL;
+    mMap = (const uint8_t*)MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    if (mMap == NULL) {
+      CloseHandle(mMapping);
+      mMapping = NULL;
+    }
+#elif defined(__GNUC__)
+    void* data = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, mFile, 0);
+    if (data == MAP_FAILED)
+      return NULL;
+    madvise(data, bytes, MADV_SEQUENTIAL);
+    mMap = (const uint8_t*)data;
+#endif
+    if (mMap != NULL)
+      mMapSize = bytes;
+    return mMap;
+  }
+
+  void unmap(void)
+  {
+    if (mMap == NULL)
+      return;
+#if defined(WIN32)
+    UnmapViewOfFile(mMap);
+    CloseHandle(mMapping);
+    mMapping = NULL;
+#elif defined(__GNUC__)
+    munmap((void*)mMap, mMapSize);
+#endif
+    mMap = NULL;
+    mMapSize = 0;
+  }
+
+private:
+#if defined(WIN32)
+  typedef HANDLE Semaphore;
+  static inline void waitFor(Semaphore& s) { WaitForSingleObject(s, INFINITE); }
+  static inline void signal(Semaphore& s) { ReleaseSemaphore(s, 1, NULL); }
+#elif defined(__GNUC__)
+  typedef sem_t Semaphore;
+  static inline void waitFor(Semaphore& s) { while (sem_wait(&s) != 0) /* EINTR */; }
+  static inline void signal(Semaphore& s) { sem_post(&s); }
+#endif
+
+  // liefert die Anzahl gelesener Bytes, 0 am Dateiende, -1 bei Fehlern
+  int64_t readChunk(uint8_t* buf, uint64_t offset)
+  {
+    if (offset >= mSize)
+      return 0;
+    const size_t bytes = (mSize - offset < mChunkSize)? (size_t)(mSize - offset) : mChunkSize;
+#if defined(WIN32)
+    OVERLAPPED ov = { 0 };
+    ov.Offset = (DWORD)(offset & 0xffffffffU);
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD bytesRead = 0;
+    if (!ReadFile(mFile, buf, (DWORD)bytes, &bytesRead, &ov))
+      return -1;
+    return (int64_t)bytesRead;
+#elif defined(__GNUC__)
+    ssize_t bytesRead;
+    do {
+      bytesRead = pread(mFile, buf, bytes, (off_t)offset);
+    } while (bytesRead < 0 && errno == EINTR);
+    return (int64_t)bytesRead;
+#endif
+  }
+
+  // liest die Datei blockweise abwechselnd in mBuf[0] und mBuf[1]
+#if defined(WIN32)
+  static DWORD WINAPI
+#elif defined(__GNUC__)
+  static void*
+#endif
+  ReaderThreadProc(void* lpParameter)
+  {
+    FileCrc* self = reinterpret_cast<FileCrc*>(lpParameter);
+    uint64_t offset = 0;
+    for (int i = 0; ; i ^= 1) {
+      waitFor(self->mFree);
+      int64_t bytesRead = self->readChunk(self->mBuf[i], offset);
+      if (bytesRead < 0 || (bytesRead == 0 && offset < self->mSize))
+        self->mReadError = true;
+      self->mBytesRead[i] = (bytesRead > 0)? bytesRead : 0;
+      signal(self->mFull);
+      if (self->mBytesRead[i] == 0)
+        break;
+      offset += bytesRead;
+    }
+    return 0;
+  }
+
+  const CRCIMPL& mCrcImpl;
+  const size_t mChunkSize;
+  std::string mFilename;
+  uint64_t mSize;
+#if defined(WIN32)
+  HANDLE mFile;
+  HANDLE mMapping;
+#elif defined(__GNUC__)
+  int mFile;
+#endif
+  const uint8_t* mMap;
+  size_t mMapSize;
+  uint8_t* mBuf[2];
+  int64_t mBytesRead[2];
+  bool mReadError;
+  Semaphore mFree;
+  Semaphore mFull;
+};
+
+
+#endif // __FILECRC_H_
@@ -0,0 +1,120 @@
+// Copyright (c) 2013 Oliver Lau <ola@ct.de>, Heise Zeitschriften Verlag
+// All rights reserved.
+
+#ifndef __PARALLELCRC_H_
+#define __PARALLELCRC_H_
+
+#if defined(WIN32)
+#include <Windows.h>
+#elif defined(__GNUC__)
+#include <pthread.h>
+#endif
+
+#if defined(WIN32)
+#include "gnutypes.h"
+#elif defined(__GNUC__)
+#include <stdint.h>
+#endif
+
+#include <stddef.h>
+#include <vector>
+
+
+// Berechnet den CRC eines einzelnen Speicherblocks mit mehreren Threads.
+//
+// Der Block wird in gleich grosse Scheiben zerlegt, deren CRCs
+// unabhaengig voneinander berechnet werden: die erste Scheibe mit dem
+// uebergebenen Startwert, alle weiteren mit dem Startwert 0. Anschliessend
+// werden die Teilergebnisse mit GfUtil::Concatenate() zu genau dem CRC
+// verknuepft, den eine serielle Berechnung ueber den gesamten Block
+// ergeben haette -- ohne die Daten ein zweites Mal anzufassen.
+//
+// CRCIMPL ist eine Klasse aus crcutil-fast, die CrcDefault() und Base()
+// anbietet, etwa Crc32cSSE4, Crc32cClmul oder GenericCrc<>.
+template <class CRCIMPL>
+class ParallelCrc {
+public:
+  typedef typename CRCIMPL::Crc Crc;
+
+  ParallelCrc(const CRCIMPL& crcImpl, int numThreads)
+    : mCrcImpl(crcImpl)
+    , mNumThreads((numThreads > 0)? numThreads : 1)
+  { /* ... */ }
+
+  inline int numThreads(void) const
+  {
+    return mNumThreads;
+  }
+
+  Crc process(const void* data, size_t bytes, const Crc& start) const
+  {
+    const uint8_t* const buf = reinterpret_cast<const uint8_t*>(data);
+    // Scheiben auf Cache-Lines ausrichten; zu kleine Bloecke nicht aufteilen
+    size_t sliceSize = (bytes / mNumThreads) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    const int numSlices = (sliceSize < MIN_SLICE_SIZE)? 1 : mNumThreads;
+    if (numSlices == 1)
+      return mCrcImpl.CrcDefault(buf, bytes, start);
+
+    std::vector<Slice> slices(numSlices);
+    for (int i = 0; i < numSlices; ++i) {
+      slices[i].crcImpl = &mCrcImpl;
+      slices[i].data = buf + i * sliceSize;
+      slices[i].bytes = (i == numSlices - 1)? bytes - i * sliceSize : sliceSize;
+      slices[i].crc = (i == 0)? start : 0;
+    }
+
+    // die erste Scheibe im aufrufenden Thread berechnen, alle anderen in eigenen Threads
+#if defined(WIN32)
+    std::vector<HANDLE> hThread(numSlices - 1);
+    for (int i = 1; i < numSlices; ++i)
+      hThread[i - 1] = CreateThread(NULL, 0, SliceThreadProc, (LPVOID)&slices[i], 0, NULL);
+    SliceThreadProc((LPVOID)&slices[0]);
+    WaitForMultipleObjects(numSlices - 1, &hThread[0], TRUE, INFINITE);
+    for (int i = 0; i < numSlices - 1; ++i)
+      CloseHandle(hThread[i]);
+#elif defined(__GNUC__)
+    std::vector<pthread_t> hThread(numSlices - 1);
+    for (int i = 1; i < numSlices; ++i)
+      pthread_create(&hThread[i - 1], NULL, SliceThreadProc, (void*)&slices[i]);
+    SliceThreadProc((void*)&slices[0]);
+    for (int i = 0; i < numSlices - 1; ++i)
+      pthread_join(hThread[i], NULL);
+#endif
+
+    // Teilergebnisse der Reihe nach verknuepfen
+    Crc crc = slices[0].crc;
+    for (int i = 1; i < numSlices; ++i)
+      crc = mCrcImpl.Base().Concatenate(crc, slices[i].crc, slices[i].bytes);
+    return crc;
+  }
+
+private:
+  static const size_t CACHE_LINE_SIZE = 64;
+  // unterhalb dieser Groesse lohnt das Erzeugen von Threads nicht
+  static const size_t MIN_SLICE_SIZE = 256 * 1024;
+
+  struct Slice {
+    const CRCIMPL* crcImpl;
+    const uint8_t* data;
+    size_t bytes;
+    Crc crc; // Eingabe: Startwert, Ausgabe: CRC der Scheibe
+  };
+
+#if defined(WIN32)
+  static DWORD WINAPI
+#elif defined(__GNUC__)
+  static void*
+#endif
+  SliceThreadProc(void* lpParameter)
+  {
+    Slice* slice = reinterpret_cast<Slice*>(lpParameter);
+    slice->crc = slice->crcImpl->CrcDefault(slice->data, slice->bytes, slice->crc);
+    return 0;
+  }
+
+  const CRCIMPL& mCrcImpl;
+  const int mNumThreads;
+};
+
+
+#endif // __PARALLELCRC_H_
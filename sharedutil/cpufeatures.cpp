@@ -13,6 +13,22 @@
 
 #include "cpufeatures.h"
 
+
+// Liest das Extended Control Register XCR0, aus dem hervorgeht,
+// ob das Betriebssystem die AVX- bzw. AVX-512-Register beim
+// Kontextwechsel sichert.
+static uint64_t readXCR0(void)
+{
+#if defined(WIN32)
+  return _xgetbv(0);
+#elif defined(__GNUC__)
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+
 CPUFeatures::CPUFeatures(void) 
   : cores(0)
   , threads_per_package(0)
@@ -183,6 +199,29 @@ void CPUFeatures::detectFeatures(void)
   mmx_supported = (r.edx & (1<<23)) != 0;
   sse_supported = (r.edx & (1<<25)) != 0;
   sse2_supported = (r.edx & (1<<26)) != 0;
+  pclmulqdq_supported = (r.ecx & (1<<1)) != 0;
+  osxsave_supported = (r.ecx & (1<<27)) != 0;
+
+  // XMM- und YMM-Zustand (Bits 1 und 2) bzw. zusaetzlich
+  // Opmask- und ZMM-Zustand (Bits 5 bis 7) muessen vom
+  // Betriebssystem gesichert werden
+  const uint64_t xcr0 = osxsave_supported? readXCR0() : 0;
+  os_avx_enabled = (xcr0 & 0x06) == 0x06;
+  os_avx512_enabled = (xcr0 & 0xe6) == 0xe6;
+
+  avx2_supported = false;
+  avx512f_supported = false;
+  vpclmulqdq_supported = false;
+  if (max_func >= 7) {
+#if defined(WIN32)
+    __cpuidex(r.reg, 7, 0);
+#elif defined(__GNUC__)
+    __get_cpuidex(7, 0, &r.eax, &r.ebx, &r.ecx, &r.edx);
+#endif
+    avx2_supported = (r.ebx & (1<<5)) != 0;
+    avx512f_supported = (r.ebx & (1<<16)) != 0;
+    vpclmulqdq_supported = (r.ecx & (1<<10)) != 0;
+  }
 }
 
 
@@ -323,3 +362,23 @@ bool CPUFeatures::isAESSupported(void) const {
 bool CPUFeatures::isRdRandSupported(void) const {
   return isGenuineIntelCPU() && rdrand_supported;
 }
+
+
+bool CPUFeatures::isClmulSupported(void) const {
+  return pclmulqdq_supported;
+}
+
+
+bool CPUFeatures::isAVX2Supported(void) const {
+  return avx_supported && avx2_supported && os_avx_enabled;
+}
+
+
+bool CPUFeatures::isAVX512Supported(void) const {
+  return avx512f_supported && os_avx512_enabled;
+}
+
+
+bool CPUFeatures::isVPCLMULQDQSupported(void) const {
+  return isClmulSupported() && isAVX512Supported() && vpclmulqdq_supported;
+}
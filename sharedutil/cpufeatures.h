@@ -44,6 +44,10 @@ public:
   bool isCRCSupported(void) const;
   bool isAESSupported(void) const;
   bool isRdRandSupported(void) const;
+  bool isClmulSupported(void) const;
+  bool isAVX2Supported(void) const;
+  bool isAVX512Supported(void) const;
+  bool isVPCLMULQDQSupported(void) const;
   void evaluateCPUFeatures(void);
   int getNumCores(void) const;
   static void lockToLogicalProcessor(int core);
@@ -82,6 +86,13 @@ public: // member variables
   bool avx_supported;
   bool f16c_supported;
   bool rdrand_supported;
+  bool pclmulqdq_supported;
+  bool osxsave_supported;
+  bool avx2_supported;
+  bool avx512f_supported;
+  bool vpclmulqdq_supported;
+  bool os_avx_enabled;
+  bool os_avx512_enabled;
   bool mmx_supported;
   bool sse_supported;
   bool sse2_supported;